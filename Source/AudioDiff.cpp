@@ -1,9 +1,101 @@
 #include "AudioDiff.h"
 
+#include "WorkStealingQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <juce_dsp/juce_dsp.h>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+/* The metrics of a channel, summed up over the chunks compared by one thread */
+struct ChannelTotals {
+    double sumOfSquares{ 0.0 };
+    float peak{ 0.f };
+    std::optional<juce::int64> firstDivergentSample;
+    juce::int64 numSamplesAboveTolerance{ 0 };
+
+    void add(const ChannelTotals& other) {
+        sumOfSquares += other.sumOfSquares;
+        peak = std::max(peak, other.peak);
+        if (other.firstDivergentSample &&
+            (!firstDivergentSample || *other.firstDivergentSample < *firstDivergentSample)) {
+            firstDivergentSample = other.firstDivergentSample;
+        }
+        numSamplesAboveTolerance += other.numSamplesAboveTolerance;
+    }
+};
+
+/**
+ * Adds a chunk of a channel to its totals.
+ *
+ * @param difference Scratch space for the chunk's difference.
+ * @param position The position of the chunk in the files.
+ */
+static void compareChunk(
+    const float* test, const float* reference, float* difference, int numSamples,
+    juce::int64 position, float tolerance, ChannelTotals& totals
+) {
+    juce::FloatVectorOperations::subtract(difference, test, reference, numSamples);
+
+    const auto range = juce::FloatVectorOperations::findMinAndMax(difference, numSamples);
+    totals.peak = std::max({ totals.peak, std::abs(range.getStart()), std::abs(range.getEnd()) });
+
+    // independent lanes, so the compiler can vectorize the loop without reordering any sum
+    constexpr int numLanes = 4;
+    std::array<double, numLanes> sumsOfSquares{};
+    std::array<juce::int64, numLanes> numAboveTolerance{};
+    const auto numVectorizedSamples = numSamples - numSamples % numLanes;
+    for (int i = 0; i < numVectorizedSamples; i += numLanes) {
+        for (int lane = 0; lane < numLanes; lane++) {
+            const auto sample = difference[i + lane];
+            sumsOfSquares[lane] += static_cast<double>(sample) * sample;
+            numAboveTolerance[lane] += std::abs(sample) > tolerance ? 1 : 0;
+        }
+    }
+    for (int i = numVectorizedSamples; i < numSamples; i++) {
+        const auto sample = difference[i];
+        sumsOfSquares[0] += static_cast<double>(sample) * sample;
+        numAboveTolerance[0] += std::abs(sample) > tolerance ? 1 : 0;
+    }
+
+    juce::int64 numChunkSamplesAboveTolerance = 0;
+    for (int lane = 0; lane < numLanes; lane++) {
+        totals.sumOfSquares += sumsOfSquares[lane];
+        numChunkSamplesAboveTolerance += numAboveTolerance[lane];
+    }
+    totals.numSamplesAboveTolerance += numChunkSamplesAboveTolerance;
+
+    // slices are compared out of order, so an earlier divergent sample may still turn up
+    if (numChunkSamplesAboveTolerance > 0 &&
+        (!totals.firstDivergentSample || position < *totals.firstDivergentSample)) {
+        const auto* first = std::find_if(difference, difference + numSamples, [&](float sample) {
+            return std::abs(sample) > tolerance;
+        });
+        const auto firstDivergentSample = position + (first - difference);
+        if (!totals.firstDivergentSample || firstDivergentSample < *totals.firstDivergentSample) {
+            totals.firstDivergentSample = firstDivergentSample;
+        }
+    }
+}
+
 std::expected<AudioDiff, std::map<AudioFileRole, juce::String>>
 AudioDiff::create(const std::map<AudioFileRole, juce::File>& audioFiles) {
     AudioDiff diff{};
-    diff.formatManager->registerBasicFormats();
+    {
+        // the format manager is shared by all instances, which may be created concurrently
+        static std::mutex formatsMutex;
+        const std::scoped_lock lock{formatsMutex};
+        if (diff.formatManager->getNumKnownFormats() == 0) {
+            diff.formatManager->registerBasicFormats();
+        }
+    }
     std::map<AudioFileRole, juce::String> errorMessages{};
 
     auto results = diff.remap(audioFiles);
@@ -25,57 +117,552 @@ std::map<AudioFileRole, juce::Result>
 AudioDiff::remap(const std::map<AudioFileRole, juce::File>& audioFiles) {
     std::map<AudioFileRole, juce::Result> results;
     for (const auto& [role, file] : audioFiles) {
-        results.insert({role, readBufferFromFile(file, role)});
+        results.insert({role, openReader(file, role)});
     }
     return results;
 }
 
-[[nodiscard]] juce::Result AudioDiff::readBufferFromFile(const juce::File& file,
-                                                         AudioFileRole role) {
+[[nodiscard]] juce::Result AudioDiff::openReader(const juce::File& file, AudioFileRole role) {
     using namespace juce;
 
     if (!file.existsAsFile()) {
         return Result::fail("Input file '" + file.getFullPathName() + "' not found.");
     }
 
-    if (std::unique_ptr<juce::AudioFormatReader> reader{formatManager->createReaderFor(file)}) {
-        const auto numChannels = static_cast<int>(reader->numChannels);
-        const auto numSamples = static_cast<int>(reader->lengthInSamples);
+    std::unique_ptr<AudioFormatReader> reader{formatManager->createReaderFor(file)};
+    if (!reader) {
+        return Result::fail("Could not read file: " + file.getFullPathName());
+    }
+
+    files[role] = file;
+    readers[role] = std::move(reader);
+    return Result::ok();
+}
+
+std::vector<AudioDiff::ReaderPair> AudioDiff::openReaderPairs(std::size_t maxNumPairs) const {
+    std::vector<ReaderPair> pairs;
+    for (std::size_t i = 0; i < maxNumPairs; i++) {
+        ReaderPair pair{
+            std::unique_ptr<juce::AudioFormatReader>{
+                formatManager->createReaderFor(files.at(AudioFileRole::test))},
+            std::unique_ptr<juce::AudioFormatReader>{
+                formatManager->createReaderFor(files.at(AudioFileRole::reference))},
+        };
+        // use fewer threads if the files can't be opened again
+        if (!pair.test || !pair.reference) {
+            break;
+        }
+        pairs.push_back(std::move(pair));
+    }
+    return pairs;
+}
 
-        audio[role].setSize(numChannels, numSamples,
-                            false, // keepExistingContent
-                            true,  // clearExtraSpace
-                            false  // avoidReallocating
-        );
+/**
+ * @return The amount of samples of two signals that overlap when the test signal is shifted
+ * by the lag.
+ */
+static juce::int64 getOverlap(std::size_t referenceLength, std::size_t testLength,
+                              juce::int64 lag) {
+    const auto begin = std::max<juce::int64>(0, -lag);
+    const auto end = std::min(static_cast<juce::int64>(referenceLength),
+                              static_cast<juce::int64>(testLength) - lag);
+    return std::max<juce::int64>(0, end - begin);
+}
 
-        reader->read(&audio[role], 0, numSamples, 0, true, true);
+/**
+ * Cross-correlates two signals at a single lag, multiplying the reference's sample i with the
+ * test's sample i + lag. Normalized by the overlap, so lags with less overlap aren't penalized.
+ */
+static double correlateAt(const std::vector<float>& reference, const std::vector<float>& test,
+                          juce::int64 lag) {
+    const auto overlap = getOverlap(reference.size(), test.size(), lag);
+    if (overlap == 0) {
+        return 0.0;
+    }
 
-        return Result::ok();
-    } else {
-        return Result::fail("Could not read file: " + file.getFullPathName());
+    const auto begin = std::max<juce::int64>(0, -lag);
+    double sum = 0.0;
+    for (auto i = begin; i < begin + overlap; ++i) {
+        sum += static_cast<double>(reference[static_cast<std::size_t>(i)]) *
+               test[static_cast<std::size_t>(i + lag)];
     }
+    return sum / static_cast<double>(overlap);
 }
 
+/**
+ * Finds the lag at which the cross-correlation of two signals peaks, computing the
+ * correlation at every lag at once through an FFT.
+ *
+ * @param maxLag The largest lag to consider in either direction.
+ */
+static juce::int64 findCorrelationPeak(const std::vector<float>& reference,
+                                       const std::vector<float>& test, juce::int64 maxLag) {
+    // zero-padded, so the circular correlation doesn't wrap around
+    int order = 1;
+    while ((std::size_t{1} << order) < reference.size() + test.size()) {
+        order++;
+    }
+    const auto size = std::size_t{1} << order;
+    juce::dsp::FFT fft{order};
+
+    auto transform = [&](const std::vector<float>& samples) {
+        std::vector<std::complex<float>> input(size);
+        std::copy(samples.begin(), samples.end(), input.begin());
+        std::vector<std::complex<float>> spectrum(size);
+        fft.perform(input.data(), spectrum.data(), false);
+        return spectrum;
+    };
+
+    // multiplying with the reference's conjugate gives the spectrum of the cross-correlation
+    auto spectrum = transform(test);
+    const auto referenceSpectrum = transform(reference);
+    for (std::size_t i = 0; i < size; ++i) {
+        spectrum[i] *= std::conj(referenceSpectrum[i]);
+    }
+    std::vector<std::complex<float>> correlation(size);
+    fft.perform(spectrum.data(), correlation.data(), true);
+
+    juce::int64 peakLag = 0;
+    double peak = -std::numeric_limits<double>::infinity();
+    for (auto lag = -maxLag; lag <= maxLag; ++lag) {
+        const auto overlap = getOverlap(reference.size(), test.size(), lag);
+        if (overlap == 0) {
+            continue;
+        }
+
+        // negative lags wrap around to the end
+        const auto index =
+            static_cast<std::size_t>(lag >= 0 ? lag : static_cast<juce::int64>(size) + lag);
+        const auto value =
+            static_cast<double>(correlation[index].real()) / static_cast<double>(overlap);
+        if (value > peak) {
+            peak = value;
+            peakLag = lag;
+        }
+    }
+    return peakLag;
+}
+
+std::vector<float> AudioDiff::readMonoExcerpt(AudioFileRole role, int length) const {
+    auto& reader = *readers.at(role);
+    const auto numSamples = static_cast<int>(std::min<juce::int64>(length, reader.lengthInSamples));
+    const auto numChannels = static_cast<int>(reader.numChannels);
+
+    std::vector<float> mono(static_cast<std::size_t>(std::max(numSamples, 0)), 0.f);
+    if (numSamples <= 0 || numChannels == 0) {
+        return mono;
+    }
+
+    juce::AudioBuffer<float> buffer{numChannels, numSamples};
+    reader.read(&buffer, 0, numSamples, 0, true, true);
+    for (auto chan = 0; chan < numChannels; ++chan) {
+        juce::FloatVectorOperations::addWithMultiply(mono.data(), buffer.getReadPointer(chan),
+                                                     1.f / static_cast<float>(numChannels),
+                                                     numSamples);
+    }
+    return mono;
+}
+
+juce::int64 AudioDiff::findTestOffset(juce::int64 maxOffset) const {
+    jassert(maxOffset >= 0 && maxOffset <= maxAlignmentOffset);
+    maxOffset = std::clamp<juce::int64>(maxOffset, 0, maxAlignmentOffset);
+    const auto excerptLength = static_cast<int>(alignmentLength + maxOffset);
+    const auto reference = readMonoExcerpt(AudioFileRole::reference, excerptLength);
+    const auto test = readMonoExcerpt(AudioFileRole::test, excerptLength);
+    if (reference.empty() || test.empty()) {
+        return 0;
+    }
+
+    // coarse pass: decimate, so the FFT stays small no matter how far the search reaches
+    constexpr std::size_t maxCoarseLength = 1 << 16;
+    std::size_t factor = 1;
+    while ((reference.size() + test.size()) / factor > maxCoarseLength) {
+        factor *= 2;
+    }
+    auto decimate = [&](const std::vector<float>& samples) {
+        // averaging each group of samples filters out most of what would alias
+        std::vector<float> decimated(samples.size() / factor);
+        for (std::size_t i = 0; i < decimated.size(); ++i) {
+            const auto group = samples.begin() + static_cast<std::ptrdiff_t>(i * factor);
+            const auto sum =
+                std::accumulate(group, group + static_cast<std::ptrdiff_t>(factor), 0.f);
+            decimated[i] = sum / static_cast<float>(factor);
+        }
+        return decimated;
+    };
+    const auto coarseReference = decimate(reference);
+    const auto coarseTest = decimate(test);
+    const auto signedFactor = static_cast<juce::int64>(factor);
+    const auto coarseOffset =
+        coarseReference.empty() || coarseTest.empty()
+            ? 0
+            : findCorrelationPeak(coarseReference, coarseTest, maxOffset / signedFactor) *
+                  signedFactor;
+
+    // fine pass: the coarse offset is off by less than the decimation factor
+    auto offset = coarseOffset;
+    double peak = -std::numeric_limits<double>::infinity();
+    for (auto lag = std::max(-maxOffset, coarseOffset - signedFactor);
+         lag <= std::min(maxOffset, coarseOffset + signedFactor); ++lag) {
+        if (const auto value = correlateAt(reference, test, lag); value > peak) {
+            peak = value;
+            offset = lag;
+        }
+    }
+    return offset;
+}
+
+void AudioDiff::setTestOffset(juce::int64 offset) { testOffset = offset; }
+
 [[nodiscard]] float AudioDiff::getDifferenceRMS() const {
-    auto& reference = audio.at(AudioFileRole::reference);
-    auto& test = audio.at(AudioFileRole::test);
+    const auto numThreads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    return static_cast<float>(getDifferenceMetrics(0.f, numThreads).rms);
+}
+
+[[nodiscard]] DifferenceMetrics AudioDiff::getDifferenceMetrics(float tolerance,
+                                                                int numThreads) const {
+    const auto& reference = *readers.at(AudioFileRole::reference);
+    const auto& test = *readers.at(AudioFileRole::test);
+
+    // the file that's late is read from the offset on
+    const auto testStart = std::max<juce::int64>(testOffset, 0);
+    const auto referenceStart = std::max<juce::int64>(-testOffset, 0);
 
-    const auto numSamples = std::min(reference.getNumSamples(), test.getNumSamples());
-    const auto numChannels = std::min(reference.getNumChannels(), test.getNumChannels());
+    DifferenceMetrics metrics;
+    metrics.testOffset = testOffset;
+    metrics.numSamples = std::max<juce::int64>(
+        0, std::min(reference.lengthInSamples - referenceStart, test.lengthInSamples - testStart));
+    const auto numChannels = static_cast<int>(std::min(reference.numChannels, test.numChannels));
+    if (metrics.numSamples <= 0 || numChannels == 0) {
+        return metrics;
+    }
+
+    // every thread reads through its own readers, since readers can't be shared between threads.
+    // the first thread uses the readers that are already open.
+    const auto numSlices = (metrics.numSamples + sliceLength - 1) / sliceLength;
+    const auto numWorkers =
+        static_cast<std::size_t>(std::clamp<juce::int64>(numThreads, 1, numSlices));
+    const auto extraReaders = openReaderPairs(numWorkers - 1);
+
+    // deal the slices out in order, workers that finish early steal the rest
+    const auto numThreadsUsed = extraReaders.size() + 1;
+    WorkStealingQueue<juce::int64> queue{numThreadsUsed};
+    for (juce::int64 slice = 0; slice < numSlices; slice++) {
+        const auto worker = static_cast<std::size_t>(slice) * numThreadsUsed /
+                            static_cast<std::size_t>(numSlices);
+        queue.push(worker, slice);
+    }
+
+    // every worker sums up its own totals, so workers don't need to synchronize
+    std::vector<std::vector<ChannelTotals>> workerTotals(
+        numThreadsUsed, std::vector<ChannelTotals>(static_cast<std::size_t>(numChannels)));
+    auto work = [&](std::size_t workerIndex, juce::AudioFormatReader& testReader,
+                    juce::AudioFormatReader& referenceReader) {
+        juce::AudioBuffer<float> testChunk{static_cast<int>(testReader.numChannels), chunkLength};
+        juce::AudioBuffer<float> referenceChunk{static_cast<int>(referenceReader.numChannels),
+                                                chunkLength};
+        std::vector<float> difference(static_cast<std::size_t>(chunkLength));
+        auto& totals = workerTotals[workerIndex];
+
+        while (const auto slice = queue.pop(workerIndex)) {
+            const auto sliceEnd = std::min(metrics.numSamples, (*slice + 1) * sliceLength);
+            for (auto position = *slice * sliceLength; position < sliceEnd;
+                 position += chunkLength) {
+                const auto numChunkSamples =
+                    static_cast<int>(std::min<juce::int64>(chunkLength, sliceEnd - position));
+
+                testReader.read(&testChunk, 0, numChunkSamples, testStart + position, true,
+                                true);
+                referenceReader.read(&referenceChunk, 0, numChunkSamples,
+                                     referenceStart + position, true, true);
+
+                for (auto chan = 0; chan < numChannels; ++chan) {
+                    compareChunk(testChunk.getReadPointer(chan),
+                                 referenceChunk.getReadPointer(chan), difference.data(),
+                                 numChunkSamples, referenceStart + position, tolerance,
+                                 totals[static_cast<std::size_t>(chan)]);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < numThreadsUsed; i++) {
+        threads.emplace_back(work, i, std::ref(*extraReaders[i - 1].test),
+                             std::ref(*extraReaders[i - 1].reference));
+    }
+    work(0, *readers.at(AudioFileRole::test), *readers.at(AudioFileRole::reference));
+    for (auto& thread : threads) {
+        thread.join();
+    }
 
-    juce::AudioBuffer<float> difference{numChannels, numSamples};
+    double totalRMS = 0.0;
 
     for (auto chan = 0; chan < numChannels; ++chan) {
-        difference.copyFrom(chan, 0, test, chan, 0, numSamples);
+        ChannelTotals totals;
+        for (const auto& worker : workerTotals) {
+            totals.add(worker[static_cast<std::size_t>(chan)]);
+        }
+
+        auto& channel = metrics.channels.emplace_back();
+        channel.rms = std::sqrt(totals.sumOfSquares / static_cast<double>(metrics.numSamples));
+        channel.peak = totals.peak;
+        channel.firstDivergentSample = totals.firstDivergentSample;
+        channel.numSamplesAboveTolerance = totals.numSamplesAboveTolerance;
+
+        totalRMS += channel.rms;
+        metrics.peak = std::max(metrics.peak, channel.peak);
+        if (channel.firstDivergentSample &&
+            (!metrics.firstDivergentSample ||
+             *channel.firstDivergentSample < *metrics.firstDivergentSample)) {
+            metrics.firstDivergentSample = channel.firstDivergentSample;
+        }
+        metrics.numSamplesAboveTolerance += channel.numSamplesAboveTolerance;
+    }
+
+    metrics.rms = totalRMS / numChannels;
+    return metrics;
+}
+
+bool SpectralDifference::passed() const {
+    return std::ranges::all_of(bands, [](const Band& band) { return band.passed(); });
+}
+
+/* The magnitude error of a band, summed up over the frames compared by one thread */
+struct BandTotals {
+    double sumOfSquares{ 0.0 };
+    double worstFrameError{ 0.0 };
+    juce::int64 worstFramePosition{ 0 };
+
+    void add(const BandTotals& other) {
+        sumOfSquares += other.sumOfSquares;
+        // on ties, the earlier frame is kept
+        if (other.worstFrameError > worstFrameError ||
+            (other.worstFrameError == worstFrameError &&
+             other.worstFramePosition < worstFramePosition)) {
+            worstFrameError = other.worstFrameError;
+            worstFramePosition = other.worstFramePosition;
+        }
+    }
+};
+
+// Orders frames by their error, and the earlier one first on ties
+static bool isWorse(const SpectralDifference::Frame& frame,
+                    const SpectralDifference::Frame& other) {
+    return frame.error > other.error ||
+           (frame.error == other.error && frame.position < other.position);
+}
 
-        juce::FloatVectorOperations::subtract(difference.getWritePointer(chan),
-                                              reference.getReadPointer(chan), numSamples);
+/**
+ * Adds a frame to the worst frames if it's worse than one of them, keeping them sorted with
+ * isWorse and at most the given amount.
+ */
+static void addWorstFrame(std::vector<SpectralDifference::Frame>& worstFrames,
+                          SpectralDifference::Frame frame, std::size_t maxNumFrames) {
+    const auto position =
+        std::ranges::find_if(worstFrames, [&](const SpectralDifference::Frame& worstFrame) {
+            return isWorse(frame, worstFrame);
+        });
+    if (position == worstFrames.end() && worstFrames.size() >= maxNumFrames) {
+        return;
+    }
+    worstFrames.insert(position, std::move(frame));
+    if (worstFrames.size() > maxNumFrames) {
+        worstFrames.pop_back();
     }
+}
+
+[[nodiscard]] SpectralDifference AudioDiff::getSpectralDifference(
+    int fftOrder, const std::vector<SpectralBand>& bands, int numThreads) const {
+    const auto& reference = *readers.at(AudioFileRole::reference);
+    const auto& test = *readers.at(AudioFileRole::test);
 
-    float totalRMS = 0.f;
+    const auto testStart = std::max<juce::int64>(testOffset, 0);
+    const auto referenceStart = std::max<juce::int64>(-testOffset, 0);
 
-    for (auto chan = 0; chan < numChannels; ++chan)
-        totalRMS += difference.getRMSLevel(chan, 0, numSamples);
+    SpectralDifference difference;
+    difference.fftSize = 1 << fftOrder;
+    difference.hopSize = difference.fftSize / 2;
+    difference.sampleRate = reference.sampleRate;
+    difference.testOffset = testOffset;
+    difference.numSamples = std::max<juce::int64>(
+        0, std::min(reference.lengthInSamples - referenceStart, test.lengthInSamples - testStart));
+
+    const auto fftSize = difference.fftSize;
+    const auto hopSize = difference.hopSize;
+    const auto numBins = fftSize / 2 + 1;
+    const auto numBands = bands.size();
+    const auto nyquist = difference.sampleRate / 2.0;
+    for (std::size_t band = 0; band < numBands; band++) {
+        difference.bands.push_back({
+            .lowFrequency = bands[band].lowFrequency,
+            .highFrequency = band + 1 < numBands ? bands[band + 1].lowFrequency : nyquist,
+            .tolerance = bands[band].tolerance,
+        });
+    }
 
-    return totalRMS / static_cast<float>(numChannels);
-}
\ No newline at end of file
+    const auto numChannels = static_cast<int>(std::min(reference.numChannels, test.numChannels));
+    if (difference.numSamples <= 0 || numChannels == 0 || numBands == 0) {
+        return difference;
+    }
+
+    // frames run until one covers the last sample, padded with silence past the end
+    difference.numFrames = (std::max<juce::int64>(difference.numSamples - fftSize, 0) +
+                            hopSize - 1) / hopSize + 1;
+
+    // the band of each bin, or -1 if it's below the lowest band. both halves of the spectrum
+    // contribute to the bins between DC and Nyquist, so they count twice.
+    std::vector<int> binBands(static_cast<std::size_t>(numBins), -1);
+    std::vector<float> binWeights(static_cast<std::size_t>(numBins), 2.f);
+    binWeights.front() = binWeights.back() = 1.f;
+    for (auto bin = 0; bin < numBins; ++bin) {
+        const auto frequency = bin * difference.sampleRate / fftSize;
+        for (std::size_t band = 0; band < numBands; band++) {
+            if (frequency >= bands[band].lowFrequency) {
+                binBands[static_cast<std::size_t>(bin)] = static_cast<int>(band);
+            }
+        }
+    }
+
+    std::vector<float> window(static_cast<std::size_t>(fftSize));
+    juce::dsp::WindowingFunction<float>::fillWindowingTables(
+        window.data(), static_cast<std::size_t>(fftSize),
+        juce::dsp::WindowingFunction<float>::hann, false);
+    // by Parseval's theorem, this turns the energy of a frame's spectrum into the mean square
+    // of the windowed samples, averaged over the channels
+    const auto windowEnergy = std::inner_product(window.begin(), window.end(), window.begin(), 0.0);
+    const auto powerScale = 1.0 / (fftSize * windowEnergy * numChannels);
+
+    const auto numSlices = (difference.numFrames + framesPerSlice - 1) / framesPerSlice;
+    const auto numWorkers =
+        static_cast<std::size_t>(std::clamp<juce::int64>(numThreads, 1, numSlices));
+    const auto extraReaders = openReaderPairs(numWorkers - 1);
+
+    const auto numThreadsUsed = extraReaders.size() + 1;
+    WorkStealingQueue<juce::int64> queue{numThreadsUsed};
+    for (juce::int64 slice = 0; slice < numSlices; slice++) {
+        const auto worker = static_cast<std::size_t>(slice) * numThreadsUsed /
+                            static_cast<std::size_t>(numSlices);
+        queue.push(worker, slice);
+    }
+
+    std::vector<std::vector<BandTotals>> workerTotals(numThreadsUsed,
+                                                      std::vector<BandTotals>(numBands));
+    std::vector<std::vector<SpectralDifference::Frame>> workerWorstFrames(numThreadsUsed);
+    auto work = [&](std::size_t workerIndex, juce::AudioFormatReader& testReader,
+                    juce::AudioFormatReader& referenceReader) {
+        // everything a worker needs is allocated up front, and reused for every frame
+        const auto sliceSamples = static_cast<int>((framesPerSlice - 1) * hopSize + fftSize);
+        juce::AudioBuffer<float> testSlice{static_cast<int>(testReader.numChannels),
+                                           sliceSamples};
+        juce::AudioBuffer<float> referenceSlice{static_cast<int>(referenceReader.numChannels),
+                                                sliceSamples};
+        // the real-only transform works in place on twice the frame length
+        std::vector<float> testSpectrum(static_cast<std::size_t>(fftSize) * 2);
+        std::vector<float> referenceSpectrum(static_cast<std::size_t>(fftSize) * 2);
+        std::vector<double> framePowers(numBands);
+        juce::dsp::FFT fft{fftOrder};
+        auto& totals = workerTotals[workerIndex];
+        auto& worstFrames = workerWorstFrames[workerIndex];
+
+        auto transform = [&](const float* samples, std::vector<float>& spectrum) {
+            juce::FloatVectorOperations::multiply(spectrum.data(), samples, window.data(),
+                                                  fftSize);
+            fft.performFrequencyOnlyForwardTransform(spectrum.data(), true);
+        };
+
+        while (const auto slice = queue.pop(workerIndex)) {
+            const auto firstFrame = *slice * framesPerSlice;
+            const auto endFrame = std::min(difference.numFrames, firstFrame + framesPerSlice);
+            const auto sliceStart = firstFrame * hopSize;
+            // the end of the shorter file is followed by silence in both
+            const auto numAvailableSamples = static_cast<int>(std::clamp<juce::int64>(
+                difference.numSamples - sliceStart, 0, sliceSamples));
+
+            testSlice.clear();
+            referenceSlice.clear();
+            testReader.read(&testSlice, 0, numAvailableSamples, testStart + sliceStart, true,
+                            true);
+            referenceReader.read(&referenceSlice, 0, numAvailableSamples,
+                                 referenceStart + sliceStart, true, true);
+
+            for (auto frame = firstFrame; frame < endFrame; ++frame) {
+                const auto offset = static_cast<int>((frame - firstFrame) * hopSize);
+                std::ranges::fill(framePowers, 0.0);
+
+                for (auto chan = 0; chan < numChannels; ++chan) {
+                    transform(testSlice.getReadPointer(chan, offset), testSpectrum);
+                    transform(referenceSlice.getReadPointer(chan, offset), referenceSpectrum);
+
+                    for (auto bin = 0; bin < numBins; ++bin) {
+                        const auto band = binBands[static_cast<std::size_t>(bin)];
+                        if (band < 0) {
+                            continue;
+                        }
+                        const auto binIndex = static_cast<std::size_t>(bin);
+                        const auto magnitudeDifference =
+                            testSpectrum[binIndex] - referenceSpectrum[binIndex];
+                        framePowers[static_cast<std::size_t>(band)] +=
+                            binWeights[binIndex] * magnitudeDifference * magnitudeDifference;
+                    }
+                }
+
+                const auto position = referenceStart + frame * hopSize;
+                double framePower = 0.0;
+                for (std::size_t band = 0; band < numBands; band++) {
+                    const auto bandPower = framePowers[band] * powerScale;
+                    framePowers[band] = bandPower;
+                    framePower += bandPower;
+                    totals[band].add({
+                        .sumOfSquares = bandPower,
+                        .worstFrameError = std::sqrt(bandPower),
+                        .worstFramePosition = position,
+                    });
+                }
+
+                // frames without any difference aren't reported, and only frames that may
+                // make it into the worst ones are copied
+                const auto frameError = std::sqrt(framePower);
+                if (frameError > 0.0 && (worstFrames.size() < numWorstFrames ||
+                                         frameError >= worstFrames.back().error)) {
+                    std::vector<double> bandErrors(numBands);
+                    std::ranges::transform(framePowers, bandErrors.begin(),
+                                           [](double power) { return std::sqrt(power); });
+                    addWorstFrame(worstFrames, {position, frameError, std::move(bandErrors)},
+                                  numWorstFrames);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < numThreadsUsed; i++) {
+        threads.emplace_back(work, i, std::ref(*extraReaders[i - 1].test),
+                             std::ref(*extraReaders[i - 1].reference));
+    }
+    work(0, *readers.at(AudioFileRole::test), *readers.at(AudioFileRole::reference));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (std::size_t band = 0; band < numBands; band++) {
+        BandTotals totals;
+        for (const auto& worker : workerTotals) {
+            totals.add(worker[band]);
+        }
+
+        auto& result = difference.bands[band];
+        result.error = std::sqrt(totals.sumOfSquares / static_cast<double>(difference.numFrames));
+        result.worstFrameError = totals.worstFrameError;
+        result.worstFramePosition = totals.worstFramePosition;
+    }
+
+    for (auto& frames : workerWorstFrames) {
+        for (auto& frame : frames) {
+            addWorstFrame(difference.worstFrames, std::move(frame), numWorstFrames);
+        }
+    }
+    std::ranges::sort(difference.worstFrames, {}, &SpectralDifference::Frame::position);
+
+    return difference;
+}
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <expected>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <juce_audio_formats/juce_audio_formats.h>
 
@@ -25,11 +29,93 @@ constexpr std::string stringFromRole(AudioFileRole role) {
     }
 }
 
+/* How the test audio differs from the reference audio */
+struct DifferenceMetrics {
+    /* The metrics of a single channel */
+    struct Channel {
+        double rms{ 0.0 };
+        // the largest absolute difference of a single sample
+        float peak{ 0.f };
+        // the first sample whose absolute difference exceeds the tolerance, as an index into the
+        // reference audio
+        std::optional<juce::int64> firstDivergentSample;
+        juce::int64 numSamplesAboveTolerance{ 0 };
+    };
+
+    // amount of samples compared per channel, up to the end of the shorter file
+    juce::int64 numSamples{ 0 };
+    // how many samples the test audio was shifted by before comparing it
+    juce::int64 testOffset{ 0 };
+    std::vector<Channel> channels;
+
+    // the average of the channels' RMS
+    double rms{ 0.0 };
+    // the following are taken across all channels
+    float peak{ 0.f };
+    std::optional<juce::int64> firstDivergentSample;
+    juce::int64 numSamplesAboveTolerance{ 0 };
+};
+
+/* A frequency band compared by AudioDiff::getSpectralDifference */
+struct SpectralBand {
+    // the band reaches up to the next band's lowest frequency, or to the Nyquist frequency
+    double lowFrequency{ 0.0 };
+    // the largest magnitude error the band may have while still passing, as a gain
+    double tolerance{ 0.0 };
+};
+
+/* How the magnitude spectrum of the test audio differs from the reference audio's */
+struct SpectralDifference {
+    /* The error of a single band */
+    struct Band {
+        double lowFrequency{ 0.0 };
+        double highFrequency{ 0.0 };
+        double tolerance{ 0.0 };
+        // the RMS of the magnitude difference in the band, across all frames and channels
+        double error{ 0.0 };
+        // the frame in which the band's magnitude difference is the largest
+        double worstFrameError{ 0.0 };
+        juce::int64 worstFramePosition{ 0 };
+
+        [[nodiscard]] bool passed() const { return error <= tolerance; }
+    };
+
+    /* A single frame of the STFT */
+    struct Frame {
+        // the position of the frame's first sample in the reference audio
+        juce::int64 position{ 0 };
+        // the magnitude error across the whole spectrum
+        double error{ 0.0 };
+        std::vector<double> bandErrors;
+    };
+
+    int fftSize{ 0 };
+    int hopSize{ 0 };
+    double sampleRate{ 0.0 };
+    juce::int64 numSamples{ 0 };
+    juce::int64 numFrames{ 0 };
+    juce::int64 testOffset{ 0 };
+    std::vector<Band> bands;
+    // the frames with the largest magnitude error, in the order they appear in the audio
+    std::vector<Frame> worstFrames;
+
+    [[nodiscard]] bool passed() const;
+    // Converts a sample position to seconds, or 0 if the sample rate is unknown
+    [[nodiscard]] double toSeconds(juce::int64 position) const {
+        return sampleRate > 0.0 ? static_cast<double>(position) / sampleRate : 0.0;
+    }
+};
+
 /**
- * Compares two audio files
+ * Compares two audio files.
+ * The files are streamed in fixed-size chunks, so comparing them takes the same amount of memory
+ * regardless of their length.
  */
 class AudioDiff {
   public:
+    // the largest offset findTestOffset can find in either direction, in samples
+    static constexpr juce::int64 maxAlignmentOffset = 1 << 17;
+
     /**
      * Create an Audio Differ with a map of files and their roles in the testing.
      * If successful, an AudioDiff will be created.
@@ -41,11 +127,90 @@ class AudioDiff {
     [[nodiscard]] std::map<AudioFileRole, juce::Result>
     remap(const std::map<AudioFileRole, juce::File>& audioFiles);
 
+    /**
+     * Estimates how many samples the test audio lags behind the reference audio, by
+     * cross-correlating the start of both files.
+     *
+     * A coarse pass finds the peak of the cross-correlation of decimated copies of the audio
+     * using an FFT, and a fine pass refines it at the full sample rate around that peak.
+     *
+     * @param maxOffset The largest offset to consider in either direction, in samples.
+     *                  Must not be larger than maxAlignmentOffset.
+     * @return The offset, positive if the test audio is late and negative if it's early.
+     */
+    [[nodiscard]] juce::int64 findTestOffset(juce::int64 maxOffset) const;
+
+    /**
+     * Shifts the test audio before comparing it, so its sample at the offset is compared to the
+     * reference audio's first sample. With a negative offset, the reference audio is shifted
+     * instead.
+     */
+    void setTestOffset(juce::int64 offset);
+
+    /**
+     * Reads both files from the start and computes the RMS of their difference for each channel
+     * they have in common, up to the end of the shorter file.
+     *
+     * @return The average RMS of the channels' differences.
+     */
     [[nodiscard]] float getDifferenceRMS() const;
 
+    /**
+     * Compares the files like getDifferenceRMS, computing all metrics in a single pass.
+     * The files are split into slices that are compared on separate threads, each reading
+     * the files through its own readers.
+     *
+     * @param tolerance The absolute difference above which a sample counts as divergent.
+     * @param numThreads The maximum amount of threads to compare the files on.
+     */
+    [[nodiscard]] DifferenceMetrics getDifferenceMetrics(float tolerance, int numThreads) const;
+
+    /**
+     * Compares the magnitude spectra of the files in frequency bands, ignoring their phase, so
+     * a phase shift doesn't count as a difference the way a changed frequency response does.
+     *
+     * Both files are split into Hann-windowed frames overlapping by half, which are transformed
+     * by an FFT. The errors are the RMS of the difference of the magnitudes in each band, scaled
+     * so they're comparable to the RMS of a difference in the time domain.
+     * Like getDifferenceMetrics, the frames are split into slices compared on separate threads.
+     *
+     * @param fftOrder The base 2 logarithm of the frame length.
+     * @param bands The bands to report, sorted by their lowest frequency.
+     * @param numThreads The maximum amount of threads to compare the files on.
+     */
+    [[nodiscard]] SpectralDifference getSpectralDifference(int fftOrder,
+                                                           const std::vector<SpectralBand>& bands,
+                                                           int numThreads) const;
+
   private:
-    [[nodiscard]] juce::Result readBufferFromFile(const juce::File& file, AudioFileRole role);
+    // Reads the start of a file, with its channels mixed down to mono
+    [[nodiscard]] std::vector<float> readMonoExcerpt(AudioFileRole role, int length) const;
+
+    /* The test and reference readers used by one thread */
+    struct ReaderPair {
+        std::unique_ptr<juce::AudioFormatReader> test;
+        std::unique_ptr<juce::AudioFormatReader> reference;
+    };
+
+    [[nodiscard]] juce::Result openReader(const juce::File& file, AudioFileRole role);
+    // Opens up to the given amount of additional readers for both files, for other threads
+    [[nodiscard]] std::vector<ReaderPair> openReaderPairs(std::size_t maxNumPairs) const;
+
+    // amount of samples per channel read from each file at once
+    static constexpr int chunkLength = 65536;
+    // amount of samples per channel each thread compares at a time
+    static constexpr juce::int64 sliceLength = chunkLength * 16;
+    // amount of samples at the start of the files that alignment compares,
+    // so at least half of the compared audio overlaps at any offset
+    static constexpr int alignmentLength = static_cast<int>(maxAlignmentOffset * 2);
+    // amount of STFT frames each thread compares at a time
+    static constexpr juce::int64 framesPerSlice = 256;
+    // amount of the worst frames reported by the spectral comparison
+    static constexpr std::size_t numWorstFrames = 10;
+
+    juce::int64 testOffset{ 0 };
 
-    std::map<AudioFileRole, juce::AudioBuffer<float>> audio{};
+    std::map<AudioFileRole, juce::File> files{};
+    std::map<AudioFileRole, std::unique_ptr<juce::AudioFormatReader>> readers{};
     juce::SharedResourcePointer<juce::AudioFormatManager> formatManager;
 };
\ No newline at end of file
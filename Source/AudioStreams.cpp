@@ -0,0 +1,406 @@
+#include "AudioStreams.h"
+
+#include "Errors.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+
+#if JUCE_WINDOWS
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+PcmEncoding getPcmEncoding(StreamFormat format) {
+    switch (format) {
+    case StreamFormat::s24le:
+        return { .bitsPerSample = 24, .floatingPoint = false };
+    case StreamFormat::s32le:
+        return { .bitsPerSample = 32, .floatingPoint = false };
+    case StreamFormat::f32le:
+        return { .bitsPerSample = 32, .floatingPoint = true };
+    case StreamFormat::wav:
+    case StreamFormat::s16le:
+        break;
+    }
+    return { .bitsPerSample = 16, .floatingPoint = false };
+}
+
+StandardInputStream::StandardInputStream() {
+#if JUCE_WINDOWS
+    // stdin is opened in text mode, which would mangle the samples
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+}
+
+juce::int64 StandardInputStream::getTotalLength() { return -1; }
+
+bool StandardInputStream::isExhausted() {
+    const auto nextByte = std::fgetc(stdin);
+    if (nextByte == EOF) {
+        return true;
+    }
+    std::ungetc(nextByte, stdin);
+    return false;
+}
+
+int StandardInputStream::read(void* destBuffer, int maxBytesToRead) {
+    const auto numBytesRead =
+        std::fread(destBuffer, 1, static_cast<std::size_t>(std::max(0, maxBytesToRead)), stdin);
+    position += static_cast<juce::int64>(numBytesRead);
+    return static_cast<int>(numBytesRead);
+}
+
+juce::int64 StandardInputStream::getPosition() { return position; }
+
+bool StandardInputStream::setPosition(juce::int64 newPosition) {
+    if (newPosition < position) {
+        return false;
+    }
+    skipNextBytes(newPosition - position);
+    return position == newPosition;
+}
+
+StandardOutputStream::StandardOutputStream(BufferedFileOutputStream::Statistics& statisticsToUpdate)
+    : statistics(statisticsToUpdate) {
+#if JUCE_WINDOWS
+    // stdout is opened in text mode, which would mangle the samples
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+StandardOutputStream::~StandardOutputStream() { flush(); }
+
+void StandardOutputStream::flush() {
+    if (std::fflush(stdout) != 0) {
+        statistics.writeFailed = true;
+    }
+}
+
+bool StandardOutputStream::setPosition(juce::int64) { return false; }
+
+juce::int64 StandardOutputStream::getPosition() { return statistics.numBytesWritten; }
+
+bool StandardOutputStream::write(const void* dataToWrite, std::size_t numberOfBytes) {
+    const auto numBytesWritten = std::fwrite(dataToWrite, 1, numberOfBytes, stdout);
+    statistics.numWriteCalls++;
+    statistics.numBytesWritten += static_cast<juce::int64>(numBytesWritten);
+    if (numBytesWritten != numberOfBytes) {
+        statistics.writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+PcmStreamReader::PcmStreamReader(
+    juce::InputStream* sourceStream, double streamSampleRate, unsigned int numStreamChannels,
+    PcmEncoding sampleEncoding, std::optional<juce::int64> streamLengthOpt
+)
+    : juce::AudioFormatReader(sourceStream, "PCM stream"),
+      encoding(sampleEncoding),
+      lengthOpt(streamLengthOpt) {
+    sampleRate = streamSampleRate;
+    numChannels = numStreamChannels;
+    bitsPerSample = encoding.bitsPerSample;
+    lengthInSamples = lengthOpt.value_or(0);
+    // samples are always converted to floats, regardless of their encoding
+    usesFloatingPointData = true;
+}
+
+std::unique_ptr<PcmStreamReader>
+PcmStreamReader::createForWavStream(juce::InputStream* sourceStream) {
+    std::unique_ptr<juce::InputStream> stream{ sourceStream };
+    auto error = [](const std::string& reason) {
+        return FileLoadError{ std::format("Couldn't read WAV stream: {}", reason), 97 };
+    };
+    auto readId = [&] {
+        char id[4]{};
+        stream->read(id, sizeof(id));
+        return std::string(id, sizeof(id));
+    };
+    auto skipChunkRemainder = [&](juce::uint32 chunkSize, juce::uint32 numBytesConsumed) {
+        // chunks are padded to an even size
+        const auto paddedSize = static_cast<juce::int64>(chunkSize) + (chunkSize & 1);
+        stream->skipNextBytes(paddedSize - numBytesConsumed);
+    };
+
+    const auto riffId = readId();
+    stream->readInt(); // the RIFF size, which is unknown when streaming
+    if ((riffId != "RIFF" && riffId != "RF64") || readId() != "WAVE") {
+        throw error("not a WAV stream");
+    }
+
+    constexpr juce::uint16 pcmFormatTag = 1;
+    constexpr juce::uint16 floatFormatTag = 3;
+    constexpr juce::uint16 extensibleFormatTag = 0xfffe;
+    constexpr juce::uint32 unknownSize = 0xffffffff;
+
+    juce::uint16 formatTag = 0;
+    unsigned int numChannels = 0;
+    double sampleRate = 0.0;
+    unsigned int bitsPerSample = 0;
+    unsigned int bytesPerFrame = 0;
+    std::optional<juce::int64> rf64DataSizeOpt;
+
+    // read chunks up to the samples, which must be last
+    while (true) {
+        if (stream->isExhausted()) {
+            throw error("no data chunk found");
+        }
+        const auto chunkId = readId();
+        const auto chunkSize = static_cast<juce::uint32>(stream->readInt());
+
+        if (chunkId == "fmt ") {
+            formatTag = static_cast<juce::uint16>(stream->readShort());
+            numChannels = static_cast<juce::uint16>(stream->readShort());
+            sampleRate = static_cast<juce::uint32>(stream->readInt());
+            stream->readInt(); // bytes per second
+            bytesPerFrame = static_cast<juce::uint16>(stream->readShort());
+            bitsPerSample = static_cast<juce::uint16>(stream->readShort());
+            juce::uint32 numBytesConsumed = 16;
+
+            // the actual format of extensible WAV is the start of the sub-format GUID
+            if (formatTag == extensibleFormatTag && chunkSize >= 40) {
+                stream->readShort(); // extension size
+                stream->readShort(); // valid bits per sample
+                stream->readInt();   // channel mask
+                formatTag = static_cast<juce::uint16>(stream->readShort());
+                numBytesConsumed += 10;
+            }
+            skipChunkRemainder(chunkSize, numBytesConsumed);
+        } else if (chunkId == "ds64") {
+            // RF64 files keep the sizes that don't fit the regular headers here
+            stream->readInt64(); // RIFF size
+            rf64DataSizeOpt = stream->readInt64();
+            skipChunkRemainder(chunkSize, 16);
+        } else if (chunkId == "data") {
+            std::optional<juce::int64> dataSizeOpt;
+            if (riffId == "RF64" && chunkSize == unknownSize) {
+                dataSizeOpt = rf64DataSizeOpt;
+            } else if (chunkSize != 0 && chunkSize != unknownSize) {
+                dataSizeOpt = chunkSize;
+            }
+
+            const bool isSupportedPcm = formatTag == pcmFormatTag &&
+                                        (bitsPerSample == 8 || bitsPerSample == 16 ||
+                                         bitsPerSample == 24 || bitsPerSample == 32);
+            const bool isSupportedFloat = formatTag == floatFormatTag && bitsPerSample == 32;
+            if (!isSupportedPcm && !isSupportedFloat) {
+                throw error(std::format(
+                    "unsupported sample format {} with {} bits per sample", formatTag,
+                    bitsPerSample
+                ));
+            }
+            if (numChannels == 0 || sampleRate <= 0.0 ||
+                bytesPerFrame != numChannels * bitsPerSample / 8) {
+                throw error("invalid format chunk");
+            }
+
+            std::optional<juce::int64> lengthOpt;
+            if (dataSizeOpt) {
+                lengthOpt = *dataSizeOpt / bytesPerFrame;
+            }
+            return std::make_unique<PcmStreamReader>(
+                stream.release(), sampleRate, numChannels,
+                PcmEncoding{ .bitsPerSample = bitsPerSample,
+                    .floatingPoint = formatTag == floatFormatTag },
+                lengthOpt
+            );
+        } else {
+            skipChunkRemainder(chunkSize, 0);
+        }
+    }
+}
+
+bool PcmStreamReader::readSamples(
+    int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile, int numSamples
+) {
+    // the stream can't be rewound, so blocks have to be read in order, though they may skip ahead
+    if (startSampleInFile > numSamplesRead && !ended) {
+        skipSamples(startSampleInFile - numSamplesRead);
+    }
+    if (startSampleInFile != numSamplesRead && !ended) {
+        jassertfalse;
+        return false;
+    }
+
+    juce::int64 numSamplesToRead = ended ? 0 : numSamples;
+    if (lengthOpt) {
+        numSamplesToRead = std::min(numSamplesToRead, *lengthOpt - numSamplesRead);
+    }
+
+    const auto bytesPerFrame = static_cast<std::size_t>(numChannels * encoding.bitsPerSample / 8);
+    const auto numBytesToRead = static_cast<std::size_t>(numSamplesToRead) * bytesPerFrame;
+    if (readBufferSize < numBytesToRead) {
+        readBuffer.malloc(numBytesToRead);
+        readBufferSize = numBytesToRead;
+    }
+
+    // pipes can deliver less than requested, so keep reading until the stream ends
+    std::size_t numBytesRead = 0;
+    while (numBytesRead < numBytesToRead) {
+        const auto result = input->read(
+            readBuffer.get() + numBytesRead, static_cast<int>(numBytesToRead - numBytesRead)
+        );
+        if (result <= 0) {
+            break;
+        }
+        numBytesRead += static_cast<std::size_t>(result);
+    }
+
+    // a partial frame at the end of the stream is dropped
+    const auto numFramesRead = static_cast<int>(numBytesRead / bytesPerFrame);
+    numSamplesRead += numFramesRead;
+
+    // find out whether the stream ended right away,
+    // so callers can stop before reading a block of nothing but silence
+    if (numFramesRead < numSamplesToRead || (lengthOpt && numSamplesRead >= *lengthOpt) ||
+        input->isExhausted()) {
+        ended = true;
+    }
+
+    using LE = juce::AudioData::LittleEndian;
+    using Float32 = juce::AudioData::Float32;
+    auto convert = [&]<typename SourceSampleType>() {
+        ReadHelper<Float32, SourceSampleType, LE>::read(
+            destChannels, startOffsetInDestBuffer, numDestChannels, readBuffer.get(),
+            static_cast<int>(numChannels), numFramesRead
+        );
+    };
+    if (encoding.floatingPoint) {
+        convert.template operator()<Float32>();
+    } else if (encoding.bitsPerSample == 8) {
+        convert.template operator()<juce::AudioData::UInt8>();
+    } else if (encoding.bitsPerSample == 16) {
+        convert.template operator()<juce::AudioData::Int16>();
+    } else if (encoding.bitsPerSample == 24) {
+        convert.template operator()<juce::AudioData::Int24>();
+    } else {
+        convert.template operator()<juce::AudioData::Int32>();
+    }
+
+    // past the end of the stream, there's only silence
+    for (int channel = 0; channel < numDestChannels; channel++) {
+        if (auto* dest = reinterpret_cast<float*>(destChannels[channel])) {
+            std::fill(
+                dest + startOffsetInDestBuffer + numFramesRead,
+                dest + startOffsetInDestBuffer + numSamples, 0.0f
+            );
+        }
+    }
+
+    return true;
+}
+
+void PcmStreamReader::skipSamples(juce::int64 numSamplesToSkip) {
+    if (lengthOpt) {
+        numSamplesToSkip = std::min(numSamplesToSkip, *lengthOpt - numSamplesRead);
+    }
+
+    const auto bytesPerFrame = static_cast<juce::int64>(numChannels * encoding.bitsPerSample / 8);
+    const auto numBytesToSkip = numSamplesToSkip * bytesPerFrame;
+    const auto startPosition = input->getPosition();
+    input->skipNextBytes(numBytesToSkip);
+    const auto numBytesSkipped = input->getPosition() - startPosition;
+
+    // skipped samples count as read, so positions in the stream stay the same
+    numSamplesRead += numBytesSkipped / bytesPerFrame;
+    if (numBytesSkipped < numBytesToSkip || (lengthOpt && numSamplesRead >= *lengthOpt) ||
+        input->isExhausted()) {
+        ended = true;
+    }
+}
+
+bool PcmStreamReader::hasEnded() const { return ended; }
+
+juce::int64 PcmStreamReader::getNumSamplesRead() const { return numSamplesRead; }
+
+/* Converts non-interleaved float samples into interleaved little-endian samples */
+template<typename DestSampleType>
+static void interleaveSamples(
+    const float* const* channels, int numChannels, void* dest, int numSamples
+) {
+    using Source = juce::AudioData::Pointer<
+        juce::AudioData::Float32, juce::AudioData::NativeEndian, juce::AudioData::NonInterleaved,
+        juce::AudioData::Const>;
+    using Dest = juce::AudioData::Pointer<
+        DestSampleType, juce::AudioData::LittleEndian, juce::AudioData::Interleaved,
+        juce::AudioData::NonConst>;
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        Dest destChannel{ juce::addBytesToPointer(dest, channel * Dest::getBytesPerSample()),
+            numChannels };
+        if (channels[channel] == nullptr) {
+            destChannel.clearSamples(numSamples);
+        } else {
+            destChannel.convertSamples(Source{ channels[channel] }, numSamples);
+        }
+    }
+}
+
+PcmStreamWriter::PcmStreamWriter(
+    juce::OutputStream* destStream, double streamSampleRate, unsigned int numStreamChannels,
+    PcmEncoding sampleEncoding, bool writeWavHeader
+)
+    : juce::AudioFormatWriter(
+          destStream, "PCM stream", streamSampleRate, numStreamChannels,
+          sampleEncoding.bitsPerSample
+      ),
+      encoding(sampleEncoding) {
+    // samples are always passed to write() as floats, regardless of their encoding
+    usesFloatingPointData = true;
+
+    if (!writeWavHeader) {
+        return;
+    }
+
+    // the sizes aren't known until the stream ends, so they're declared as large as possible
+    constexpr int unknownSize = -1;
+    const auto bytesPerFrame = static_cast<int>(numChannels * bitsPerSample / 8);
+    output->write("RIFF", 4);
+    output->writeInt(unknownSize);
+    output->write("WAVEfmt ", 8);
+    output->writeInt(16);
+    output->writeShort(encoding.floatingPoint ? 3 : 1);
+    output->writeShort(static_cast<short>(numChannels));
+    output->writeInt(static_cast<int>(sampleRate));
+    output->writeInt(static_cast<int>(sampleRate) * bytesPerFrame);
+    output->writeShort(static_cast<short>(bytesPerFrame));
+    output->writeShort(static_cast<short>(bitsPerSample));
+    output->write("data", 4);
+    output->writeInt(unknownSize);
+}
+
+bool PcmStreamWriter::write(const int** samplesToWrite, int numSamples) {
+    const auto* const* channels = reinterpret_cast<const float* const*>(samplesToWrite);
+    const auto numStreamChannels = static_cast<int>(numChannels);
+    const auto numBytes =
+        static_cast<std::size_t>(numSamples) * numChannels * (encoding.bitsPerSample / 8);
+    writeBuffer.resize(numBytes);
+
+    if (encoding.floatingPoint) {
+        interleaveSamples<juce::AudioData::Float32>(
+            channels, numStreamChannels, writeBuffer.data(), numSamples
+        );
+    } else if (encoding.bitsPerSample == 8) {
+        // 8 bit WAV is unsigned
+        interleaveSamples<juce::AudioData::UInt8>(
+            channels, numStreamChannels, writeBuffer.data(), numSamples
+        );
+    } else if (encoding.bitsPerSample == 16) {
+        interleaveSamples<juce::AudioData::Int16>(
+            channels, numStreamChannels, writeBuffer.data(), numSamples
+        );
+    } else if (encoding.bitsPerSample == 24) {
+        interleaveSamples<juce::AudioData::Int24>(
+            channels, numStreamChannels, writeBuffer.data(), numSamples
+        );
+    } else {
+        interleaveSamples<juce::AudioData::Int32>(
+            channels, numStreamChannels, writeBuffer.data(), numSamples
+        );
+    }
+
+    return output->write(writeBuffer.data(), numBytes);
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "BufferedFileOutputStream.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The path standing for stdin or stdout in place of an audio file
+inline const std::string standardStreamPath{ "-" };
+
+/* Formats of audio streamed through stdin and stdout. Raw PCM is interleaved and little-endian */
+enum class StreamFormat { wav, s16le, s24le, s32le, f32le };
+
+inline const std::unordered_map<std::string, StreamFormat> streamFormatMap{
+    { "wav", StreamFormat::wav },     { "s16le", StreamFormat::s16le },
+    { "s24le", StreamFormat::s24le }, { "s32le", StreamFormat::s32le },
+    { "f32le", StreamFormat::f32le },
+};
+
+/* How the samples of a PCM stream are encoded */
+struct PcmEncoding {
+    unsigned int bitsPerSample{ 16 };
+    bool floatingPoint{ false };
+};
+
+/**
+ * @param format A raw PCM format.
+ * @return The sample encoding of the format.
+ */
+PcmEncoding getPcmEncoding(StreamFormat format);
+
+/**
+ * Reads the process's standard input.
+ * Only supports seeking forward, which skips the data in between.
+ */
+class StandardInputStream : public juce::InputStream {
+  public:
+    StandardInputStream();
+
+    juce::int64 getTotalLength() override;
+    // Waits for more data to arrive if none is buffered yet
+    bool isExhausted() override;
+    int read(void* destBuffer, int maxBytesToRead) override;
+    juce::int64 getPosition() override;
+    bool setPosition(juce::int64 newPosition) override;
+
+  private:
+    juce::int64 position{ 0 };
+};
+
+/**
+ * Writes to the process's standard output. Doesn't support seeking.
+ */
+class StandardOutputStream : public juce::OutputStream {
+  public:
+    /**
+     * @param statistics Counters to update while writing. Must outlive the stream.
+     */
+    explicit StandardOutputStream(BufferedFileOutputStream::Statistics& statistics);
+    ~StandardOutputStream() override;
+
+    void flush() override;
+    bool setPosition(juce::int64 newPosition) override;
+    juce::int64 getPosition() override;
+    bool write(const void* dataToWrite, std::size_t numberOfBytes) override;
+
+  private:
+    BufferedFileOutputStream::Statistics& statistics;
+};
+
+/**
+ * Reads interleaved PCM from a stream in a single pass, without seeking,
+ * so streams of unknown length like pipes can be read.
+ *
+ * Blocks must be read in order, though reading may skip ahead, which discards the samples
+ * in between. Samples past the end of the stream are read as silence.
+ * lengthInSamples is zero if the length is unknown, in which case the stream is read until
+ * it ends.
+ */
+class PcmStreamReader : public juce::AudioFormatReader {
+  public:
+    /**
+     * @param sourceStream The stream to read from, which is owned by the reader.
+     * @param sampleRate The sample rate of the stream.
+     * @param numChannels The amount of interleaved channels.
+     * @param encoding How the samples are encoded.
+     * @param lengthOpt The length of the stream in samples, if known.
+     */
+    PcmStreamReader(
+        juce::InputStream* sourceStream, double sampleRate, unsigned int numChannels,
+        PcmEncoding encoding, std::optional<juce::int64> lengthOpt
+    );
+
+    /**
+     * Reads the header of a WAV stream, leaving the stream at the start of the samples.
+     * WAV streams written to pipes usually don't declare their length,
+     * so the samples are read until the stream ends in that case.
+     *
+     * @param sourceStream The stream to read from, which is owned by the reader.
+     * @return The reader for the samples.
+     * @throws FileLoadError If the header can't be read or the encoding isn't supported.
+     */
+    static std::unique_ptr<PcmStreamReader> createForWavStream(juce::InputStream* sourceStream);
+
+    bool readSamples(
+        int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+        juce::int64 startSampleInFile, int numSamples
+    ) override;
+
+    /**
+     * @return Whether the end of the stream, or its declared length, has been reached.
+     */
+    bool hasEnded() const;
+
+    /**
+     * @return The amount of samples read or skipped in the stream so far, excluding silence
+     * read past its end.
+     */
+    juce::int64 getNumSamplesRead() const;
+
+  private:
+    // Reads and discards samples, counting them as read
+    void skipSamples(juce::int64 numSamplesToSkip);
+
+    PcmEncoding encoding;
+    std::optional<juce::int64> lengthOpt;
+    juce::int64 numSamplesRead{ 0 };
+    bool ended{ false };
+    // interleaved samples as read from the stream
+    juce::HeapBlock<char> readBuffer;
+    std::size_t readBufferSize{ 0 };
+};
+
+/**
+ * Writes interleaved PCM to a stream without ever seeking,
+ * so the output can be written to pipes.
+ *
+ * WAV headers declare an unknown length, as is customary for streamed WAV.
+ */
+class PcmStreamWriter : public juce::AudioFormatWriter {
+  public:
+    /**
+     * @param destStream The stream to write to, which is owned by the writer.
+     * @param sampleRate The sample rate of the stream.
+     * @param numChannels The amount of interleaved channels.
+     * @param encoding How to encode the samples. WAV supports 8 to 32 bit integers,
+     * raw PCM 16 to 32 bit integers, and both support 32 bit floats.
+     * @param writeWavHeader Whether to write a WAV header before the samples.
+     */
+    PcmStreamWriter(
+        juce::OutputStream* destStream, double sampleRate, unsigned int numChannels,
+        PcmEncoding encoding, bool writeWavHeader
+    );
+
+    bool write(const int** samplesToWrite, int numSamples) override;
+
+  private:
+    PcmEncoding encoding;
+    // interleaved samples to write to the stream
+    std::vector<char> writeBuffer;
+};
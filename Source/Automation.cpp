@@ -9,13 +9,15 @@
 #include <cstddef>
 #include <iterator>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <limits>
 #include <map>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 ParameterAutomation Automation::parseAutomationDefinition(
-    const std::string& jsonStr, const juce::AudioPluginInstance& plugin, double sampleRate,
+    const std::string& jsonStr, const ParameterIndex& parameters, double sampleRate,
     std::size_t inputLengthInSamples
 ) {
     auto json = nlohmann::json::parse(jsonStr);
@@ -28,7 +30,7 @@ ParameterAutomation Automation::parseAutomationDefinition(
     // and text values into normalized float values
     ParameterAutomation automation;
     for (const auto& [paramName, automationDefinition] : def) {
-        auto* param = PluginUtils::getPluginParameterByName(plugin, paramName);
+        auto* param = parameters.get(paramName);
 
         AutomationKeyframes keyframes;
 
@@ -67,6 +69,10 @@ ParameterAutomation Automation::parseAutomationDefinition(
             }
         }
 
+        if (keyframes.empty()) {
+            throw std::runtime_error("No keyframes given for parameter '" + paramName + "'");
+        }
+
         automation[paramName] = keyframes;
 
         if (usedTextFormat && !parameterSupportsTextToValueConversion(param)) {
@@ -142,49 +148,85 @@ float Automation::getParameterValueFromJSONPrimitive(
     throw std::invalid_argument("Invalid parameter value type. Must be a number or string");
 }
 
-void Automation::applyParameters(
-    juce::AudioPluginInstance& plugin, const ParameterAutomation& automation, size_t sampleIndex
-) {
+ResolvedAutomation
+Automation::resolve(const ParameterAutomation& automation, const ParameterIndex& parameters) {
+    ResolvedAutomation resolved;
+    resolved.reserve(automation.size());
 
     for (const auto& [paramName, keyframes] : automation) {
-        // find parameter
-        auto* param = PluginUtils::getPluginParameterByName(plugin, paramName);
-
-        // interpolate value for current sample index based on keyframes.
-        float value;
-        {
-            // find first keyframe with time that is greater than the sample time.
-            // this works because std::map is sorted by key in ascending order
-            auto nextKeyframe = std::upper_bound(
-                keyframes.begin(), keyframes.end(), sampleIndex,
-                [](size_t _sampleIndex, const std::pair<size_t, float>& keyframe) {
-                    return _sampleIndex < keyframe.first;
-                }
-            );
+        resolved.push_back({
+            .parameter = parameters.get(paramName),
+            .curve = AutomationCurve{ keyframes },
+        });
+    }
+
+    return resolved;
+}
 
-            if (nextKeyframe == keyframes.begin()) {
-                // use the value of the first keyframe
-                value = nextKeyframe->second;
+void Automation::applyParameters(ResolvedAutomation& automation, size_t sampleIndex) {
+    for (auto& [param, curve] : automation) {
+        param->setValue(curve.getValueAt(sampleIndex));
+    }
+}
 
-            } else if (nextKeyframe == keyframes.end()) {
-                // use the value of the last keyframe
-                value = std::prev(nextKeyframe)->second;
+size_t Automation::getNextKeyframeTime(ResolvedAutomation& automation, size_t sampleIndex) {
+    auto nextKeyframeTime = std::numeric_limits<size_t>::max();
+    for (auto& [param, curve] : automation) {
+        nextKeyframeTime = std::min(nextKeyframeTime, curve.getNextKeyframeTime(sampleIndex));
+    }
+    return nextKeyframeTime;
+}
 
-            } else {
-                // linearly interpolate between the two keyframes
-                auto prevKeyframe = std::prev(nextKeyframe);
+AutomationCurve::AutomationCurve(const AutomationKeyframes& keyframes) {
+    jassert(!keyframes.empty());
 
-                auto keyframeDistance = nextKeyframe->first - prevKeyframe->first;
-                auto relativePos =
-                    (float) (sampleIndex - prevKeyframe->first) / (float) keyframeDistance;
+    times.reserve(keyframes.size());
+    values.reserve(keyframes.size());
 
-                value = std::lerp(prevKeyframe->second, nextKeyframe->second, relativePos);
-            }
-        }
+    // std::map is sorted by key in ascending order, so the times end up sorted as well
+    for (const auto& [time, value] : keyframes) {
+        times.push_back(time);
+        values.push_back(value);
+    }
+}
+
+void AutomationCurve::seek(size_t sampleIndex) {
+    if (cursor == 0 || times[cursor - 1] > sampleIndex) {
+        // starting out, which may be far into the curve when only part of the inputs is rendered,
+        // or going back to an earlier sample index than last time - search from scratch
+        cursor = static_cast<size_t>(std::ranges::upper_bound(times, sampleIndex) - times.begin());
+    }
+
+    // advance to the first keyframe with time that is greater than the sample time
+    while (cursor < times.size() && times[cursor] <= sampleIndex) {
+        cursor++;
+    }
+}
 
-        // apply the value
-        param->setValue(value);
+size_t AutomationCurve::getNextKeyframeTime(size_t sampleIndex) {
+    seek(sampleIndex);
+    return cursor < times.size() ? times[cursor] : std::numeric_limits<size_t>::max();
+}
+
+float AutomationCurve::getValueAt(size_t sampleIndex) {
+    seek(sampleIndex);
+
+    if (cursor == 0) {
+        // use the value of the first keyframe
+        return values.front();
     }
+
+    if (cursor == times.size()) {
+        // use the value of the last keyframe
+        return values.back();
+    }
+
+    // linearly interpolate between the two keyframes
+    const auto prev = cursor - 1;
+    auto keyframeDistance = times[cursor] - times[prev];
+    auto relativePos = (float) (sampleIndex - times[prev]) / (float) keyframeDistance;
+
+    return std::lerp(values[prev], values[cursor], relativePos);
 }
 
 bool Automation::parameterSupportsTextToValueConversion(
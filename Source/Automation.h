@@ -1,9 +1,12 @@
 #pragma once
 
+#include "Utils.h"
+
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_core/juce_core.h>
 #include <map>
 #include <nlohmann/json.hpp>
+#include <vector>
 
 /**
  * Automation keyframes, with keys representing the timestamp of the keyframe in samples,
@@ -17,6 +20,61 @@ typedef std::map<size_t, float> AutomationKeyframes;
  */
 typedef std::map<std::string, AutomationKeyframes> ParameterAutomation;
 
+/**
+ * Automation keyframes of a single parameter, stored as sorted arrays of
+ * keyframe times and values for fast sequential evaluation.
+ */
+class AutomationCurve {
+  public:
+    /**
+     * @param keyframes The keyframes. Must contain at least one keyframe.
+     */
+    explicit AutomationCurve(const AutomationKeyframes& keyframes);
+
+    /**
+     * Evaluates the curve at the given sample index by linearly interpolating
+     * between the surrounding keyframes.
+     * Evaluating at non-decreasing sample indices costs amortized constant time,
+     * since the curve remembers where it was evaluated last.
+     *
+     * @param sampleIndex The sample index to evaluate the curve at.
+     * @return The normalized parameter value.
+     */
+    float getValueAt(size_t sampleIndex);
+
+    /**
+     * @param sampleIndex The sample index to search from.
+     * @return The time of the first keyframe later than the given sample index,
+     * or the maximum value of size_t if there is none.
+     */
+    size_t getNextKeyframeTime(size_t sampleIndex);
+
+  private:
+    // moves the cursor to the first keyframe later than the given sample index
+    void seek(size_t sampleIndex);
+
+    std::vector<size_t> times;
+    std::vector<float> values;
+
+    // index of the first keyframe later than the sample index evaluated last
+    size_t cursor{ 0 };
+};
+
+/**
+ * The automation of a single parameter,
+ * with the parameter already looked up on the plugin.
+ */
+struct ResolvedParameterAutomation {
+    juce::AudioProcessorParameter* parameter;
+    AutomationCurve curve;
+};
+
+/**
+ * Parameter automation with all parameter names resolved to the plugin's parameters,
+ * so it can be applied during processing without any lookups.
+ */
+typedef std::vector<ResolvedParameterAutomation> ResolvedAutomation;
+
 /**
  * Functions for handling parameter automation.
  */
@@ -26,7 +84,7 @@ class Automation {
      * Parses a parameter automation definition from a JSON string.
      *
      * @param jsonStr The JSON string to parse.
-     * @param plugin The plugin the parameter definition is for.
+     * @param parameters The parameters of the plugin the parameter definition is for.
      * @param sampleRate The sample rate to use for conversion of seconds to samples.
      * @param inputLengthInSamples The input's total length to use for conversion of percentage
      * values.
@@ -35,23 +93,42 @@ class Automation {
      * @throws std::runtime_error If it contains multiple keyframe times that resolve to the same value in samples.
      * @throws std::runtime_error If it contains a parameter name unknown to the plugin.
      * @throws std::runtime_error If a text parameter is used for a parameter that doesn't support it.
+     * @throws std::runtime_error If a parameter's automation object contains no keyframes.
      */
     static ParameterAutomation parseAutomationDefinition(const std::string& jsonStr,
-                                                         const juce::AudioPluginInstance& plugin,
+                                                         const ParameterIndex& parameters,
                                                          double sampleRate,
                                                          size_t inputLengthInSamples);
 
     /**
-     * Applies automation data to the given plugin.
+     * Resolves the parameter names of the given automation data to the plugin's parameters.
      *
-     * @param plugin The plugin to apply the automation to.
-     * @param automation The automation to apply.
-     * @param sampleIndex The sample index for which to evaluate parameter values.
+     * @param automation The automation data to resolve.
+     * @param parameters The parameters of the plugin the automation is for.
+     * @return The resolved automation data.
      * @throws std::runtime_error If the automation data contains a parameter name unknown to the
      * plugin.
      */
-    static void applyParameters(juce::AudioPluginInstance& plugin,
-                                const ParameterAutomation& automation, size_t sampleIndex);
+    static ResolvedAutomation resolve(const ParameterAutomation& automation,
+                                      const ParameterIndex& parameters);
+
+    /**
+     * Applies automation data to the parameters it was resolved to.
+     *
+     * @param automation The automation to apply.
+     * @param sampleIndex The sample index for which to evaluate parameter values.
+     */
+    static void applyParameters(ResolvedAutomation& automation, size_t sampleIndex);
+
+    /**
+     * Finds the earliest keyframe of any parameter that lies after the given sample index.
+     *
+     * @param automation The automation to search.
+     * @param sampleIndex The sample index to search from.
+     * @return The keyframe's time in samples,
+     * or the maximum value of size_t if there is no later keyframe.
+     */
+    static size_t getNextKeyframeTime(ResolvedAutomation& automation, size_t sampleIndex);
 
     /**
      * Tests whether calling the given parameter's <code>textToValue</code> function
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * A fixed ring of preallocated audio blocks that is passed through a chain of stages,
+ * each running on its own thread.
+ *
+ * Every stage works on the blocks in order, and a block only becomes available to a stage
+ * once the previous stage has released it. The first stage reuses the blocks released by the
+ * last stage. Each stage's position in the ring is only ever advanced by that stage's thread,
+ * so handing blocks from one stage to the next doesn't need any locks.
+ */
+template<typename SampleType>
+class BlockPipeline {
+  public:
+    struct Block {
+        juce::AudioBuffer<SampleType> buffer;
+        // index of the block's first sample within the render
+        size_t sampleIndex{ 0 };
+    };
+
+    /**
+     * @param numStages The amount of stages blocks are passed through.
+     * @param numBlocks The amount of blocks in the ring.
+     * @param numChannels The amount of channels of each block's buffer.
+     * @param blockSize The length of each block's buffer in samples.
+     */
+    BlockPipeline(size_t numStages, size_t numBlocks, int numChannels, int blockSize)
+        : blocks(numBlocks), positions(numStages), finished(numStages) {
+        jassert(numStages > 0 && numBlocks > 0);
+        for (auto& block : blocks) {
+            block.buffer.setSize(numChannels, blockSize);
+        }
+    }
+
+    /**
+     * Waits until the next block is available to the given stage.
+     * Must only be called from the stage's thread.
+     *
+     * @param stage The stage index.
+     * @return The block, or nullptr if the previous stage has finished and released all of its
+     * blocks, or the pipeline has been cancelled.
+     */
+    Block* acquire(size_t stage) {
+        while (true) {
+            const auto observedGeneration = generation.load(std::memory_order_acquire);
+
+            if (cancelled.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+
+            const auto position = positions[stage].load(std::memory_order_relaxed);
+
+            if (stage == 0) {
+                // the first stage may run ahead of the last stage by the size of the ring
+                const auto lastStagePosition = positions.back().load(std::memory_order_acquire);
+                if (position < lastStagePosition + blocks.size()) {
+                    return &blocks[position % blocks.size()];
+                }
+            } else {
+                // once the previous stage is finished, its position doesn't change anymore
+                const auto previousFinished = finished[stage - 1].load(std::memory_order_acquire);
+                if (position < positions[stage - 1].load(std::memory_order_acquire)) {
+                    return &blocks[position % blocks.size()];
+                }
+                if (previousFinished) {
+                    return nullptr;
+                }
+            }
+
+            generation.wait(observedGeneration, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * Hands the block last acquired by the given stage on to the next stage.
+     * Must only be called from the stage's thread.
+     */
+    void release(size_t stage) {
+        positions[stage].fetch_add(1, std::memory_order_release);
+        notify();
+    }
+
+    /**
+     * Signals that the given stage won't release any more blocks.
+     * Must only be called from the stage's thread.
+     */
+    void finish(size_t stage) {
+        finished[stage].store(true, std::memory_order_release);
+        notify();
+    }
+
+    /**
+     * Makes all current and future calls to acquire return nullptr.
+     * Used to shut the pipeline down when one of the stages fails.
+     */
+    void cancel() {
+        cancelled.store(true, std::memory_order_release);
+        notify();
+    }
+
+  private:
+    void notify() {
+        generation.fetch_add(1, std::memory_order_release);
+        generation.notify_all();
+    }
+
+    std::vector<Block> blocks;
+    // amount of blocks each stage has released so far
+    std::vector<std::atomic<size_t>> positions;
+    std::vector<std::atomic<bool>> finished;
+    std::atomic<bool> cancelled{ false };
+    // changes whenever any stage makes progress, for waiting stages to wait on
+    std::atomic<std::uint32_t> generation{ 0 };
+};
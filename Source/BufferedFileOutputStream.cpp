@@ -0,0 +1,114 @@
+#include "BufferedFileOutputStream.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#if JUCE_LINUX || JUCE_MAC
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+static constexpr std::size_t pageSize = 4096;
+
+void BufferedFileOutputStream::AlignedDeleter::operator()(char* data) const {
+    ::operator delete[](data, std::align_val_t{ pageSize });
+}
+
+BufferedFileOutputStream::BufferedFileOutputStream(
+    const juce::File& fileToWriteTo, std::size_t bufferSizeToUse, juce::int64 expectedSize,
+    Statistics& statisticsToUpdate
+)
+    : file(fileToWriteTo),
+      fileStream(std::make_unique<juce::FileOutputStream>(fileToWriteTo, 0)),
+      bufferSize(std::max(pageSize, (bufferSizeToUse + pageSize - 1) / pageSize * pageSize)),
+      statistics(statisticsToUpdate) {
+    buffer.reset(static_cast<char*>(::operator new[](bufferSize, std::align_val_t{ pageSize })));
+
+    if (openedOk() && expectedSize > 0) {
+        reserveDiskSpace(expectedSize);
+    }
+}
+
+BufferedFileOutputStream::~BufferedFileOutputStream() { flushBuffer(); }
+
+bool BufferedFileOutputStream::openedOk() const { return fileStream->openedOk(); }
+
+bool BufferedFileOutputStream::hasFailed() const { return statistics.writeFailed; }
+
+void BufferedFileOutputStream::flush() { flushBuffer(); }
+
+bool BufferedFileOutputStream::flushBuffer() {
+    if (bytesInBuffer == 0) {
+        return true;
+    }
+
+    // the buffer is emptied either way, a failed write is remembered by the statistics
+    const auto succeeded = writeToFile(buffer.get(), bytesInBuffer);
+    bytesInBuffer = 0;
+    return succeeded;
+}
+
+bool BufferedFileOutputStream::setPosition(juce::int64 newPosition) {
+    if (!flushBuffer()) {
+        return false;
+    }
+    return fileStream->setPosition(newPosition);
+}
+
+juce::int64 BufferedFileOutputStream::getPosition() {
+    return fileStream->getPosition() + static_cast<juce::int64>(bytesInBuffer);
+}
+
+bool BufferedFileOutputStream::write(const void* dataToWrite, std::size_t numberOfBytes) {
+    const auto* data = static_cast<const char*>(dataToWrite);
+
+    if (bytesInBuffer + numberOfBytes <= bufferSize) {
+        std::memcpy(buffer.get() + bytesInBuffer, data, numberOfBytes);
+        bytesInBuffer += numberOfBytes;
+        return true;
+    }
+
+    if (!flushBuffer()) {
+        return false;
+    }
+
+    // data that doesn't fit into the buffer anyway is written directly
+    if (numberOfBytes >= bufferSize) {
+        return writeToFile(data, numberOfBytes);
+    }
+
+    std::memcpy(buffer.get(), data, numberOfBytes);
+    bytesInBuffer = numberOfBytes;
+    return true;
+}
+
+bool BufferedFileOutputStream::writeToFile(const char* data, std::size_t numBytes) {
+    statistics.numWriteCalls++;
+    statistics.numBytesWritten += static_cast<juce::int64>(numBytes);
+    if (!fileStream->write(data, numBytes)) {
+        statistics.writeFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void BufferedFileOutputStream::reserveDiskSpace([[maybe_unused]] juce::int64 numBytes) {
+#if JUCE_LINUX || JUCE_MAC
+    const auto fd = ::open(file.getFullPathName().toRawUTF8(), O_WRONLY);
+    if (fd == -1) {
+        return;
+    }
+
+    // reserving space is merely an optimization, so failure is fine
+    #if JUCE_LINUX
+    ::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(numBytes));
+    #else
+    fstore_t store{ F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(numBytes), 0 };
+    ::fcntl(fd, F_PREALLOCATE, &store);
+    #endif
+
+    ::close(fd);
+#endif
+}
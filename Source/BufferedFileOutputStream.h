@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <juce_core/juce_core.h>
+#include <memory>
+
+/**
+ * A file output stream that collects written data in a large, page-aligned buffer,
+ * so the file only receives a write call whenever the buffer is full.
+ *
+ * On Linux and macOS, disk space for the expected file size is reserved up front,
+ * without changing the file's size.
+ */
+class BufferedFileOutputStream : public juce::OutputStream {
+  public:
+    /* Counters of the I/O the stream has performed on the file */
+    struct Statistics {
+        std::size_t numWriteCalls{ 0 };
+        juce::int64 numBytesWritten{ 0 };
+        // set once a write to the file fails, and never reset. Outlives the stream,
+        // so failures while the stream is flushed in its destructor are caught as well.
+        bool writeFailed{ false };
+    };
+
+    /**
+     * Opens the file for writing.
+     * Use openedOk to check whether the file could be opened.
+     *
+     * @param file The file to write to. If it exists, data is appended to it.
+     * @param bufferSize The buffer size in bytes. Rounded up to a multiple of the page size.
+     * @param expectedSize The expected final size of the file in bytes, used to reserve disk
+     * space. Zero if unknown.
+     * @param statistics Counters to update while writing. Must outlive the stream.
+     */
+    BufferedFileOutputStream(
+        const juce::File& file, std::size_t bufferSize, juce::int64 expectedSize,
+        Statistics& statistics
+    );
+    ~BufferedFileOutputStream() override;
+
+    bool openedOk() const;
+    /**
+     * @return Whether any write to the file has failed, in which case the file is incomplete.
+     */
+    bool hasFailed() const;
+
+    /**
+     * Writes the buffered data to the file.
+     * Unlike juce::FileOutputStream::flush, this doesn't force the data to disk.
+     */
+    void flush() override;
+    bool setPosition(juce::int64 newPosition) override;
+    juce::int64 getPosition() override;
+    bool write(const void* dataToWrite, std::size_t numberOfBytes) override;
+
+  private:
+    struct AlignedDeleter {
+        void operator()(char* data) const;
+    };
+
+    // Writes the buffered data to the file, returning false if it fails
+    bool flushBuffer();
+    bool writeToFile(const char* data, std::size_t numBytes);
+    void reserveDiskSpace(juce::int64 numBytes);
+
+    juce::File file;
+    // unbuffered, so every write to it ends up as a single write call
+    std::unique_ptr<juce::FileOutputStream> fileStream;
+    std::unique_ptr<char[], AlignedDeleter> buffer;
+    std::size_t bufferSize;
+    std::size_t bytesInBuffer{ 0 };
+    Statistics& statistics;
+};
@@ -35,4 +35,10 @@ class FailedXmlError : public CLI::Error {
   public:
     FailedXmlError(std::string msg, int exit_code)
         : CLI::Error("FailedXmlError", std::move(msg), exit_code) {}
-};
\ No newline at end of file
+};
+
+class RealtimeViolationError : public CLI::Error {
+  public:
+    RealtimeViolationError(std::string msg, int exit_code)
+        : CLI::Error("RealtimeViolationError", std::move(msg), exit_code) {}
+};
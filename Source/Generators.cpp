@@ -52,13 +52,23 @@ void GeneratorInputBus::prepare(Hertz sampleRate, juce::uint32 /* blockSize */)
     }
 }
 
-void GeneratorInputBus::processChannels(juce::dsp::AudioBlock<float>& buffer) {
+void GeneratorInputBus::skip(std::size_t numSamples) {
+    for (auto& gen : channels) {
+        gen->skip(numSamples);
+    }
+}
+
+template<typename SampleType>
+void GeneratorInputBus::processChannels(juce::dsp::AudioBlock<SampleType>& buffer) {
     for (std::size_t channel{ 0 }; channel < channels.size(); ++channel) {
         auto channelBuffer = buffer.getSingleChannelBlock(channel);
         channels[channel]->render(channelBuffer);
     }
 }
 
+template void GeneratorInputBus::processChannels(juce::dsp::AudioBlock<float>& buffer);
+template void GeneratorInputBus::processChannels(juce::dsp::AudioBlock<double>& buffer);
+
 size_t GeneratorInputBus::getDurationInSamples(Hertz sampleRate) const {
     jassert(
         juce::approximatelyEqual(sampleRate, static_cast<double>(juce::roundToInt(sampleRate)))
@@ -84,25 +94,46 @@ juce::AudioChannelSet GeneratorInputBus::getChannelLayout() const {
     return juce::AudioChannelSet::canonicalChannelSet(static_cast<int>(channels.size()));
 }
 
-void WhiteNoiseGenerator::render(juce::dsp::AudioBlock<float>& buffer) {
+void WhiteNoiseGenerator::skip(std::size_t numSamples) {
+    // draw the skipped values, so the noise continues the same as if they had been rendered
+    for (std::size_t sample{ 0 }; sample < numSamples; ++sample) {
+        random.nextDouble();
+    }
+}
+
+template<typename SampleType>
+void WhiteNoiseGenerator::renderBlock(juce::dsp::AudioBlock<SampleType>& buffer) {
     jassert(buffer.getNumChannels() == 1);
     for (std::size_t sample{ 0 }; sample < buffer.getNumSamples(); ++sample) {
         const auto val = random.nextDouble() * 2.0 - 1.0;
-        const auto scaledVal = static_cast<float>(val * amplitude);
+        const auto scaledVal = static_cast<SampleType>(val * amplitude);
         buffer.setSample(0, static_cast<int>(sample), scaledVal);
     }
 }
 
+void WhiteNoiseGenerator::render(juce::dsp::AudioBlock<float>& buffer) { renderBlock(buffer); }
+
+void WhiteNoiseGenerator::render(juce::dsp::AudioBlock<double>& buffer) { renderBlock(buffer); }
+
 void SineGenerator::prepare(Hertz sampleRate) {
     phasePerSample = juce::MathConstants<double>::twoPi / (sampleRate / frequency);
 }
 
-void SineGenerator::render(juce::dsp::AudioBlock<float>& buffer) {
+void SineGenerator::skip(std::size_t numSamples) {
+    currentPhase += phasePerSample * static_cast<double>(numSamples);
+}
+
+template<typename SampleType>
+void SineGenerator::renderBlock(juce::dsp::AudioBlock<SampleType>& buffer) {
     jassert(buffer.getNumChannels() == 1);
     for (std::size_t sample{ 0 }; sample < buffer.getNumSamples(); ++sample) {
         const auto val = std::sin(currentPhase);
-        const auto scaledVal = static_cast<float>(val * amplitude);
+        const auto scaledVal = static_cast<SampleType>(val * amplitude);
         buffer.setSample(0, static_cast<int>(sample), scaledVal);
         currentPhase += phasePerSample;
     }
 }
+
+void SineGenerator::render(juce::dsp::AudioBlock<float>& buffer) { renderBlock(buffer); }
+
+void SineGenerator::render(juce::dsp::AudioBlock<double>& buffer) { renderBlock(buffer); }
@@ -17,7 +17,10 @@ class Generator {
     virtual ~Generator() = default;
 
     virtual void prepare(Hertz /* sampleRate */) {}
+    // Advances the generator as if the given amount of samples had been rendered
+    virtual void skip(std::size_t /* numSamples */) {}
     virtual void render(juce::dsp::AudioBlock<float>& buffer) { buffer.clear(); }
+    virtual void render(juce::dsp::AudioBlock<double>& buffer) { buffer.clear(); }
 
   protected:
     double amplitude;
@@ -36,7 +39,10 @@ class GeneratorInputBus {
     static GeneratorInputBus fromJson(const nlohmann::json& json);
 
     void prepare(Hertz sampleRate, juce::uint32 blockSize);
-    void processChannels(juce::dsp::AudioBlock<float>& buffer);
+    // Advances all channels as if the given amount of samples had been rendered
+    void skip(std::size_t numSamples);
+    template<typename SampleType>
+    void processChannels(juce::dsp::AudioBlock<SampleType>& buffer);
     std::size_t getDurationInSamples(Hertz sampleRate) const;
     juce::AudioChannelSet getChannelLayout() const;
 
@@ -50,9 +56,14 @@ class WhiteNoiseGenerator : public Generator {
     WhiteNoiseGenerator(double howLoud, juce::int64 randomSeed = juce::Time::currentTimeMillis())
         : Generator(howLoud), random(randomSeed) {}
 
+    void skip(std::size_t numSamples) override;
     void render(juce::dsp::AudioBlock<float>& buffer) override;
+    void render(juce::dsp::AudioBlock<double>& buffer) override;
 
   private:
+    template<typename SampleType>
+    void renderBlock(juce::dsp::AudioBlock<SampleType>& buffer);
+
     juce::Random random;
 };
 
@@ -61,9 +72,14 @@ class SineGenerator : public Generator {
     SineGenerator(double howLoud, Hertz freq = 1000.0_Hz) : Generator(howLoud), frequency(freq) {}
 
     void prepare(Hertz sampleRate) override;
+    void skip(std::size_t numSamples) override;
     void render(juce::dsp::AudioBlock<float>& buffer) override;
+    void render(juce::dsp::AudioBlock<double>& buffer) override;
 
   private:
+    template<typename SampleType>
+    void renderBlock(juce::dsp::AudioBlock<SampleType>& buffer);
+
     double frequency;
     double currentPhase{ 0.0 };
     double phasePerSample{ 0.0 };
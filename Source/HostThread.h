@@ -0,0 +1,83 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+/**
+ * Runs functions on a single thread on behalf of other threads.
+ *
+ * Plugins expect everything but processing audio, like restoring their state or preparing them,
+ * to happen on the thread they were created on. Worker threads hand those calls to that thread
+ * with call, while that thread runs them in serve until finish is called.
+ */
+class HostThread {
+  public:
+    /**
+     * Runs the function on the thread serving the calls and waits for it to return.
+     * Exceptions thrown by the function are rethrown on the calling thread.
+     */
+    void call(const std::function<void()>& function) {
+        Call pendingCall{ .function = &function };
+        std::unique_lock lock{ mutex };
+        calls.push_back(&pendingCall);
+        condition.notify_all();
+        condition.wait(lock, [&] { return pendingCall.done; });
+        lock.unlock();
+
+        if (pendingCall.exception) {
+            std::rethrow_exception(pendingCall.exception);
+        }
+    }
+
+    /**
+     * Runs the calls made from other threads on the calling thread, until finish is called
+     * and no calls are left.
+     */
+    void serve() {
+        std::unique_lock lock{ mutex };
+        while (true) {
+            condition.wait(lock, [&] { return !calls.empty() || finished; });
+            if (calls.empty()) {
+                return;
+            }
+
+            auto* pendingCall = calls.front();
+            calls.pop_front();
+            lock.unlock();
+            try {
+                (*pendingCall->function)();
+            } catch (...) {
+                pendingCall->exception = std::current_exception();
+            }
+            lock.lock();
+
+            pendingCall->done = true;
+            condition.notify_all();
+        }
+    }
+
+    /**
+     * Makes serve return once it has run the remaining calls.
+     */
+    void finish() {
+        std::scoped_lock lock{ mutex };
+        finished = true;
+        condition.notify_all();
+    }
+
+  private:
+    /* A call waiting to be run, owned by the thread that made it */
+    struct Call {
+        const std::function<void()>* function;
+        std::exception_ptr exception;
+        bool done{ false };
+    };
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Call*> calls;
+    bool finished{ false };
+};
@@ -0,0 +1,56 @@
+#include "MidiSchedule.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstddef>
+
+MidiSchedule MidiSchedule::fromMidiFile(const juce::MidiFile& midiFile, double sampleRate) {
+    MidiSchedule schedule;
+
+    std::size_t numEvents = 0;
+    for (int i = 0; i < midiFile.getNumTracks(); i++) {
+        numEvents += static_cast<std::size_t>(midiFile.getTrack(i)->getNumEvents());
+    }
+    schedule.events.reserve(numEvents);
+
+    // we simply take MIDI events from all tracks -
+    // if the user only wants a single track of a multi-track MIDI file,
+    // they should extract that track into a separate MIDI file.
+    for (int i = 0; i < midiFile.getNumTracks(); i++) {
+        for (const auto* meh : *midiFile.getTrack(i)) {
+            schedule.events.push_back({
+                .sampleIndex = secondsToSamples(meh->message.getTimeStamp(), sampleRate),
+                .message = meh->message,
+            });
+        }
+    }
+
+    // a stable sort keeps events sharing a timestamp in track order,
+    // which is the order they used to be added to the MIDI buffer in
+    std::ranges::stable_sort(schedule.events, {}, &Event::sampleIndex);
+
+    return schedule;
+}
+
+void MidiSchedule::fillBuffer(juce::MidiBuffer& buffer, std::size_t blockStart, int numSamples) {
+    buffer.clear();
+
+    const auto blockEnd = blockStart + static_cast<std::size_t>(numSamples);
+
+    while (cursor < events.size() && events[cursor].sampleIndex < blockStart) {
+        cursor++;
+    }
+
+    while (cursor < events.size() && events[cursor].sampleIndex < blockEnd) {
+        const auto& event = events[cursor];
+        buffer.addEvent(event.message, static_cast<int>(event.sampleIndex - blockStart));
+        cursor++;
+    }
+}
+
+void MidiSchedule::seek(std::size_t sampleIndex) {
+    cursor = static_cast<std::size_t>(
+        std::ranges::lower_bound(events, sampleIndex, {}, &Event::sampleIndex) - events.begin()
+    );
+}
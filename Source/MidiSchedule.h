@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <vector>
+
+/**
+ * A flat, time-sorted list of MIDI events with timestamps in samples,
+ * merged from all tracks of a MIDI file.
+ *
+ * Events are handed out block by block using a cursor that only moves forward,
+ * so filling a block's MIDI buffer only costs the events within that block.
+ */
+class MidiSchedule {
+  public:
+    MidiSchedule() = default;
+
+    /**
+     * Merges all tracks of the given MIDI file into a single schedule.
+     *
+     * @param midiFile The MIDI file, with timestamps already converted to seconds.
+     * @param sampleRate The sample rate to use for timestamp conversion.
+     * @return The schedule.
+     */
+    static MidiSchedule fromMidiFile(const juce::MidiFile& midiFile, double sampleRate);
+
+    /**
+     * Replaces the contents of the given buffer with the events falling into
+     * <code>[blockStart, blockStart + numSamples)</code>, advancing the cursor past them.
+     * Events before <code>blockStart</code> that haven't been handed out yet are skipped.
+     *
+     * @param buffer The buffer to fill. Event positions are relative to <code>blockStart</code>.
+     * @param blockStart The sample index of the first sample in the block.
+     * @param numSamples The length of the block in samples.
+     */
+    void fillBuffer(juce::MidiBuffer& buffer, std::size_t blockStart, int numSamples);
+
+    /**
+     * Moves the cursor to the first event at or after the given sample index,
+     * so rendering can start there without going through the events before it.
+     *
+     * @param sampleIndex The sample index to continue from.
+     */
+    void seek(std::size_t sampleIndex);
+
+  private:
+    struct Event {
+        std::size_t sampleIndex;
+        juce::MidiMessage message;
+    };
+
+    std::vector<Event> events;
+    std::size_t cursor{ 0 };
+};
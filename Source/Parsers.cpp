@@ -11,6 +11,7 @@
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #define PARSE_STRICT(funName)                                                                      \
     size_t endPtr;                                                                                 \
@@ -32,6 +33,17 @@ std::chrono::seconds seconds(const std::string& secondsString) {
     throw ParseError{ std::format("Unknown time unit: {}", unit), 168 };
 }
 
+double duration(const std::string& durationString) {
+    auto [val, unit] = parse::numberAndUnits<double>(durationString);
+    if (unit == "" || string_utils::lowerCase(unit) == "s") {
+        return val;
+    }
+    if (string_utils::lowerCase(unit) == "ms") {
+        return val / 1000.0;
+    }
+    throw ParseError{ std::format("Unknown time unit: {}", unit), 168 };
+}
+
 double amplitude(const std::string& amplitudeString) {
     auto [val, unit] = parse::numberAndUnits<double>(amplitudeString);
     if (string_utils::lowerCase(unit) == "db") {
@@ -70,6 +82,36 @@ OutputFormat outputFormat(const std::string& formatName) {
     }
 }
 
+StreamFormat streamFormat(const std::string& formatName) {
+    if (streamFormatMap.contains(formatName)) {
+        return streamFormatMap.at(formatName);
+    } else {
+        // Should be validated already
+        jassertfalse;
+        return StreamFormat::wav;
+    }
+}
+
+AudioFileFormat audioFileFormat(const std::string& formatName) {
+    if (audioFileFormatMap.contains(formatName)) {
+        return audioFileFormatMap.at(formatName);
+    } else {
+        // Should be validated already
+        jassertfalse;
+        return AudioFileFormat::wav;
+    }
+}
+
+ResamplingQuality resamplingQuality(const std::string& qualityName) {
+    if (resamplingQualityMap.contains(qualityName)) {
+        return resamplingQualityMap.at(qualityName);
+    } else {
+        // Should be validated already
+        jassertfalse;
+        return ResamplingQuality::best;
+    }
+}
+
 double extractSampleRate(const std::string& jsonStringOrFilePath) {
     auto json = getJson(jsonStringOrFilePath);
     return json["sample rate"].get<double>();
@@ -135,4 +177,34 @@ ParameterCLIArgument pluginParameterArgument(const std::string& str) {
     };
 }
 
+std::vector<std::string> optionsToArguments(const nlohmann::json& options) {
+    std::vector<std::string> arguments;
+
+    auto addOption = [&](const std::string& option, const nlohmann::json& value) {
+        if (value.is_boolean()) {
+            if (value.get<bool>()) {
+                arguments.push_back(option);
+            }
+            return;
+        }
+
+        arguments.push_back(option);
+        // objects, like generator configurations, are passed on as JSON strings
+        arguments.push_back(value.is_string() ? value.get<std::string>() : value.dump());
+    };
+
+    for (const auto& [key, value] : options.items()) {
+        const auto option = "--" + key;
+        if (value.is_array()) {
+            for (const auto& element : value) {
+                addOption(option, element);
+            }
+        } else {
+            addOption(option, value);
+        }
+    }
+
+    return arguments;
+}
+
 } // namespace parse
@@ -1,12 +1,17 @@
 #pragma once
 
+#include "AudioStreams.h"
 #include "Generators.h"
+#include "Resampler.h"
 #include "Utils.h"
 
 #include <chrono>
 #include <juce_audio_formats/juce_audio_formats.h>
+#include <nlohmann/json.hpp>
+#include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 // Parsers for CLI11
 // Signature:
@@ -61,6 +66,16 @@ std::pair<T, std::string> numberAndUnits(const std::string& str) {
 
 std::chrono::seconds seconds(const std::string& secondsString);
 
+/**
+ * Parses a length of time with an optional unit, which can be s or ms.
+ * Numbers without a unit are seconds.
+ *
+ * @param durationString The duration, e.g. '1.5s' or '250ms'.
+ * @return The duration in seconds.
+ * @throws ParseError If the unit is unknown.
+ */
+double duration(const std::string& durationString);
+
 double amplitude(const std::string& amplitudeString);
 
 Hertz frequency(const std::string& freqString);
@@ -69,6 +84,12 @@ GeneratorInputBus generatorInput(const std::string& jsonStringOrFilePath);
 
 OutputFormat outputFormat(const std::string& formatName);
 
+StreamFormat streamFormat(const std::string& formatName);
+
+AudioFileFormat audioFileFormat(const std::string& formatName);
+
+ResamplingQuality resamplingQuality(const std::string& qualityName);
+
 /* Find the sample rate in the top level of the JSON object and return it */
 double extractSampleRate(const std::string& jsonString);
 
@@ -116,4 +137,15 @@ unsigned long uLongStrict(const std::string& str);
  */
 ParameterCLIArgument pluginParameterArgument(const std::string& str);
 
+/**
+ * Converts a JSON object mapping long option names to values into command line arguments.
+ * Arrays are turned into repeated options, booleans into flags that are present if true.
+ * Values that are neither strings nor booleans are passed on as JSON strings.
+ *
+ * @param options The JSON object, e.g. <code>{ "input": ["a.wav", "b.wav"], "overwrite": true
+ * }</code>.
+ * @return The arguments, e.g. <code>--input a.wav --input b.wav --overwrite</code>.
+ */
+std::vector<std::string> optionsToArguments(const nlohmann::json& options);
+
 } // namespace parse
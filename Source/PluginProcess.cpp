@@ -3,6 +3,7 @@
 #include "Automation.h"
 #include "Errors.h"
 #include "Parsers.h"
+#include "PresetLoadingExtensionsVisitor.h"
 #include "Utils.h"
 
 #include <CLI/CLI.hpp>
@@ -33,16 +34,29 @@ juce::MidiFile readMIDIFile(const juce::File& file, double sampleRate, size_t& l
     return midiFile;
 }
 
-ParameterAutomation parseParameters(
+void applyPresetFile(juce::AudioPluginInstance& plugin, const juce::File& presetFile) {
+    // read preset file into memory block
+    juce::MemoryBlock presetData;
+    const auto presetInputStream = presetFile.createInputStream();
+    presetInputStream->readIntoMemoryBlock(presetData);
+    // TODO: how to handle errors?
+
+    // apply preset
+    PresetLoadingExtensionsVisitor presetLoader(presetData);
+    plugin.getExtensions(presetLoader);
+}
+
+ResolvedAutomation parseParameters(
     const juce::AudioPluginInstance& plugin, double sampleRate, size_t inputLengthInSamples,
     const std::optional<juce::File>& parameterFileOpt, const std::vector<std::string>& cliParameters
 ) {
+    const ParameterIndex parameters{ plugin };
     ParameterAutomation automation;
 
     // read automation from file
     if (parameterFileOpt) {
         automation = Automation::parseAutomationDefinition(
-            parameterFileOpt->loadFileAsString().toStdString(), plugin, sampleRate,
+            parameterFileOpt->loadFileAsString().toStdString(), parameters, sampleRate,
             inputLengthInSamples
         );
     }
@@ -54,7 +68,7 @@ ParameterAutomation parseParameters(
 
         // convert parameter value from text representation to a single keyframe,
         // which causes the same value to be applied over the entire duration
-        auto* param = PluginUtils::getPluginParameterByName(plugin, paramName);
+        auto* param = parameters.get(paramName);
 
         if (!isNormalizedValue) {
             if (!Automation::parameterSupportsTextToValueConversion(param)) {
@@ -79,5 +93,5 @@ ParameterAutomation parseParameters(
         automation[paramName] = AutomationKeyframes({ { 0, normalizedValue } });
     }
 
-    return automation;
+    return Automation::resolve(automation, parameters);
 }
@@ -26,6 +26,15 @@ struct InputSourceVisitor : Callable... {
 juce::MidiFile
 readMIDIFile(const juce::File& file, double sampleRate, std::size_t& lengthInSamplesOut);
 
+/**
+ * Reads the given preset file and applies it to the plugin.
+ * Currently only .vstpreset files for VST3 are supported.
+ *
+ * @param plugin The plugin.
+ * @param presetFile The preset file.
+ */
+void applyPresetFile(juce::AudioPluginInstance& plugin, const juce::File& presetFile);
+
 /**
  * Parses and validates plugin parameters supplied via file and CLI.
  *
@@ -36,9 +45,9 @@ readMIDIFile(const juce::File& file, double sampleRate, std::size_t& lengthInSam
  * input audio.
  * @param parameterFileOpt The parameter file, if supplied.
  * @param cliParameters The parameters supplied via CLI.
- * @return The parsed plugin parameters.
+ * @return The parsed plugin parameters, resolved to the plugin's parameters.
  */
-ParameterAutomation parseParameters(
+ResolvedAutomation parseParameters(
     const juce::AudioPluginInstance& plugin, double sampleRate, size_t inputLengthInSamples,
     const std::optional<juce::File>& parameterFileOpt, const std::vector<std::string>& cliParameters
 );
\ No newline at end of file
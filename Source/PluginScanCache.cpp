@@ -0,0 +1,145 @@
+#include "PluginScanCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+static const juce::Identifier cacheTag{ "PLUGALYZER_SCAN_CACHE" };
+static const juce::Identifier entryTag{ "ENTRY" };
+static const juce::Identifier versionAttribute{ "version" };
+static const juce::Identifier pathAttribute{ "path" };
+static const juce::Identifier sizeAttribute{ "size" };
+static const juce::Identifier modifiedAttribute{ "modified" };
+
+// bump whenever the format of the entries changes, which discards existing caches
+static constexpr int cacheVersion = 1;
+
+static std::atomic<PluginScanCache::Mode> cacheMode{ PluginScanCache::Mode::use };
+// the cache is rebuilt only once, not for every plugin stored during a run
+static std::once_flag rebuildFlag;
+// serializes reading and rewriting the cache file within this process
+static std::mutex cacheFileMutex;
+
+/* The values a cache entry is valid for */
+struct PluginFileKey {
+    juce::String path;
+    juce::int64 size;
+    juce::int64 modified;
+};
+
+static PluginFileKey getKey(const juce::File& pluginFile) {
+    PluginFileKey key{ pluginFile.getFullPathName(), pluginFile.getSize(),
+        pluginFile.getLastModificationTime().toMilliseconds() };
+
+    // bundles change by their contents changing
+    if (pluginFile.isDirectory()) {
+        key.size = 0;
+        for (const auto& entry : juce::RangedDirectoryIterator(
+                 pluginFile, true, "*", juce::File::findFiles | juce::File::ignoreHiddenFiles
+             )) {
+            key.size += entry.getFileSize();
+            key.modified = std::max(key.modified, entry.getModificationTime().toMilliseconds());
+        }
+    }
+
+    return key;
+}
+
+static bool entryMatches(const juce::XmlElement& entry, const PluginFileKey& key) {
+    return entry.getStringAttribute(pathAttribute) == key.path &&
+           entry.getStringAttribute(sizeAttribute).getLargeIntValue() == key.size &&
+           entry.getStringAttribute(modifiedAttribute).getLargeIntValue() == key.modified;
+}
+
+// Returns nothing if the cache doesn't exist, can't be parsed or is outdated
+static std::unique_ptr<juce::XmlElement> readCache() {
+    auto cache = juce::parseXMLIfTagMatches(PluginScanCache::getCacheFile(), cacheTag);
+    if (cache == nullptr || cache->getIntAttribute(versionAttribute) != cacheVersion) {
+        return nullptr;
+    }
+    return cache;
+}
+
+void PluginScanCache::setMode(Mode mode) { cacheMode = mode; }
+
+std::optional<juce::PluginDescription> PluginScanCache::find(const juce::File& pluginFile) {
+    if (cacheMode != Mode::use) {
+        return std::nullopt;
+    }
+
+    const std::scoped_lock lock{ cacheFileMutex };
+    const auto cache = readCache();
+    if (cache == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto key = getKey(pluginFile);
+    for (const auto* entry : cache->getChildWithTagNameIterator(entryTag)) {
+        juce::PluginDescription description;
+        if (entryMatches(*entry, key) && entry->getFirstChildElement() != nullptr &&
+            description.loadFromXml(*entry->getFirstChildElement())) {
+            return description;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void PluginScanCache::store(
+    const juce::File& pluginFile, const juce::PluginDescription& description
+) {
+    if (cacheMode == Mode::bypass) {
+        return;
+    }
+
+    const std::scoped_lock lock{ cacheFileMutex };
+
+    // when rebuilding, the existing entries are discarded by the first store of the run
+    bool discardExistingEntries = false;
+    if (cacheMode == Mode::rebuild) {
+        std::call_once(rebuildFlag, [&] { discardExistingEntries = true; });
+    }
+
+    std::unique_ptr<juce::XmlElement> cache;
+    if (!discardExistingEntries) {
+        cache = readCache();
+    }
+    if (cache == nullptr) {
+        cache = std::make_unique<juce::XmlElement>(cacheTag);
+        cache->setAttribute(versionAttribute, cacheVersion);
+    }
+
+    const auto key = getKey(pluginFile);
+
+    // replace any previous entry for the plugin, outdated or not
+    for (auto* entry = cache->getFirstChildElement(); entry != nullptr;) {
+        auto* next = entry->getNextElement();
+        if (entry->getStringAttribute(pathAttribute) == key.path) {
+            cache->removeChildElement(entry, true);
+        }
+        entry = next;
+    }
+
+    auto* entry = cache->createNewChildElement(entryTag);
+    entry->setAttribute(pathAttribute, key.path);
+    entry->setAttribute(sizeAttribute, juce::String(key.size));
+    entry->setAttribute(modifiedAttribute, juce::String(key.modified));
+    entry->addChildElement(description.createXml().release());
+
+    // write to a temporary file first, so other processes never read a half-written cache
+    const auto cacheFile = getCacheFile();
+    if (!cacheFile.getParentDirectory().createDirectory()) {
+        return;
+    }
+    juce::TemporaryFile tempFile{ cacheFile };
+    if (cache->writeTo(tempFile.getFile())) {
+        tempFile.overwriteTargetFileWithTemporary();
+    }
+}
+
+juce::File PluginScanCache::getCacheFile() {
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Plugalyzer")
+        .getChildFile("PluginScanCache.xml");
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <optional>
+
+/**
+ * An on-disk cache of plugin descriptions, so plugins don't have to be scanned again
+ * every time they're loaded.
+ *
+ * Entries are keyed by the plugin's path, size and modification time.
+ * For bundles, which are directories, the size and latest modification time
+ * of the files within are used, so rebuilding a plugin invalidates its entry.
+ */
+class PluginScanCache {
+  public:
+    enum class Mode {
+        // look plugins up in the cache and add newly scanned plugins to it
+        use,
+        // neither read nor write the cache
+        bypass,
+        // clear the cache before adding newly scanned plugins to it
+        rebuild,
+    };
+
+    /**
+     * Sets how the cache is used for the rest of the program's lifetime.
+     */
+    static void setMode(Mode mode);
+
+    /**
+     * Looks up the description of the plugin at the given path.
+     *
+     * @param pluginFile The plugin's file or bundle directory.
+     * @return The cached description, or nothing if there's no up-to-date entry for the plugin.
+     */
+    static std::optional<juce::PluginDescription> find(const juce::File& pluginFile);
+
+    /**
+     * Adds the description of the plugin at the given path to the cache,
+     * replacing any previous entry for the path.
+     * Failing to write the cache isn't considered an error, since it's merely an optimization.
+     *
+     * @param pluginFile The plugin's file or bundle directory.
+     * @param description The plugin's description.
+     */
+    static void store(const juce::File& pluginFile, const juce::PluginDescription& description);
+
+    /**
+     * @return The location of the cache file.
+     */
+    static juce::File getCacheFile();
+};
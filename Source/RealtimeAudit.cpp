@@ -0,0 +1,273 @@
+#include "RealtimeAudit.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <juce_core/juce_core.h>
+#include <string>
+
+#if PLUGALYZER_REALTIME_AUDIT && JUCE_LINUX
+    #include <atomic>
+    #include <cerrno>
+    #include <cstdlib>
+    #include <dlfcn.h>
+    #include <malloc.h>
+    #include <new>
+    #include <pthread.h>
+#endif
+
+static constexpr std::array<const char*, RealtimeAudit::numViolationTypes> violationNames{
+    "allocations", "deallocations", "locks"
+};
+
+// the counts of the processBlock call the current thread is in, or nullptr if it isn't in one.
+// constinit, so reading it in the hooks doesn't run any initialization.
+static constinit thread_local std::array<std::size_t, RealtimeAudit::numViolationTypes>*
+    activeCounts{ nullptr };
+
+[[maybe_unused]] static void recordViolation(RealtimeAudit::Violation violation) {
+    if (auto* counts = activeCounts) {
+        (*counts)[static_cast<std::size_t>(violation)]++;
+    }
+}
+
+#if PLUGALYZER_REALTIME_AUDIT && JUCE_LINUX
+
+// glibc's implementations, which the hooks below forward to
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t numElements, std::size_t elementSize);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+}
+
+/* malloc and its relatives, also catching allocations made by C code and by other C++ runtimes */
+extern "C" {
+void* malloc(std::size_t size) noexcept {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t numElements, std::size_t elementSize) noexcept {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    return __libc_calloc(numElements, elementSize);
+}
+
+void* realloc(void* pointer, std::size_t size) noexcept {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    return __libc_realloc(pointer, size);
+}
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    recordViolation(RealtimeAudit::Violation::allocation);
+    auto* pointer = __libc_memalign(alignment, size);
+    if (pointer == nullptr) {
+        return ENOMEM;
+    }
+    *result = pointer;
+    return 0;
+}
+
+void free(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        recordViolation(RealtimeAudit::Violation::deallocation);
+    }
+    __libc_free(pointer);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    using LockFunction = int(pthread_mutex_t*);
+    // looked up without a function-local static, since guarding its initialization may lock
+    static std::atomic<LockFunction*> nextLock{ nullptr };
+
+    auto* lock = nextLock.load(std::memory_order_relaxed);
+    if (lock == nullptr) {
+        lock = reinterpret_cast<LockFunction*>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        nextLock.store(lock, std::memory_order_relaxed);
+    }
+
+    recordViolation(RealtimeAudit::Violation::lock);
+    return lock(mutex);
+}
+}
+
+/* The global operator new and delete, counted once rather than again in malloc and free */
+
+static void* allocate(std::size_t size) {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    // every allocation must return a distinct pointer, even one of zero bytes
+    size = std::max<std::size_t>(size, 1);
+    while (true) {
+        if (auto* pointer = __libc_malloc(size)) {
+            return pointer;
+        }
+        auto* handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+static void* allocate(std::size_t size, std::align_val_t alignment) {
+    recordViolation(RealtimeAudit::Violation::allocation);
+    size = std::max<std::size_t>(size, 1);
+    while (true) {
+        if (auto* pointer = __libc_memalign(static_cast<std::size_t>(alignment), size)) {
+            return pointer;
+        }
+        auto* handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc{};
+        }
+        handler();
+    }
+}
+
+template<typename... Alignment>
+static void* allocateNoThrow(std::size_t size, Alignment... alignment) noexcept {
+    try {
+        return allocate(size, alignment...);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+static void deallocate(void* pointer) noexcept {
+    if (pointer != nullptr) {
+        recordViolation(RealtimeAudit::Violation::deallocation);
+    }
+    __libc_free(pointer);
+}
+
+// clang-format off
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return allocateNoThrow(size, alignment); }
+
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { deallocate(pointer); }
+// clang-format on
+
+#endif
+
+std::size_t RealtimeAudit::BlockReport::getNumViolations() const {
+    std::size_t numViolations = 0;
+    for (const auto count : counts) {
+        numViolations += count;
+    }
+    return numViolations;
+}
+
+RealtimeAudit::ScopedProcessBlock::ScopedProcessBlock(
+    RealtimeAudit* auditToUpdate, std::size_t sampleIndex
+)
+    : audit(auditToUpdate), report{ .sampleIndex = sampleIndex } {
+    if (audit != nullptr) {
+        activeCounts = &report.counts;
+    }
+}
+
+RealtimeAudit::ScopedProcessBlock::~ScopedProcessBlock() {
+    if (audit != nullptr) {
+        activeCounts = nullptr;
+        audit->addBlock(report);
+    }
+}
+
+bool RealtimeAudit::isSupported() {
+#if PLUGALYZER_REALTIME_AUDIT && JUCE_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+RealtimeAudit::RealtimeAudit(double sampleRate) : sampleRate(sampleRate) {}
+
+void RealtimeAudit::addBlock(const BlockReport& report) {
+    numBlocks++;
+    const auto numViolations = report.getNumViolations();
+    if (numViolations == 0) {
+        return;
+    }
+
+    numBlocksWithViolations++;
+    for (std::size_t i = 0; i < numViolationTypes; i++) {
+        totalCounts[i] += report.counts[i];
+    }
+
+    // insert the block into the worst ones, keeping the earlier block on ties
+    auto position = std::find_if(
+        worstBlocks.begin(), worstBlocks.begin() + numWorstBlocksFound,
+        [&](const BlockReport& block) { return block.getNumViolations() < numViolations; }
+    );
+    if (position == worstBlocks.end()) {
+        return;
+    }
+    std::move_backward(position, worstBlocks.end() - 1, worstBlocks.end());
+    *position = report;
+    numWorstBlocksFound = std::min(numWorstBlocksFound + 1, numWorstBlocks);
+}
+
+std::size_t RealtimeAudit::getNumViolations() const {
+    std::size_t numViolations = 0;
+    for (const auto count : totalCounts) {
+        numViolations += count;
+    }
+    return numViolations;
+}
+
+std::string RealtimeAudit::toString() const {
+    std::string text = "Real-time safety audit:\n";
+    text += std::format(
+        "  {} of {} processBlock calls weren't real-time safe\n", numBlocksWithViolations,
+        numBlocks
+    );
+    for (std::size_t i = 0; i < numViolationTypes; i++) {
+        text += std::format("  {:<14} {}\n", violationNames[i], totalCounts[i]);
+    }
+
+    if (numWorstBlocksFound > 0) {
+        text += "\nWorst processBlock calls:\n";
+        for (std::size_t i = 0; i < numWorstBlocksFound; i++) {
+            const auto& block = worstBlocks[i];
+            text += std::format(
+                "  at sample {} ({:.3f} s): {} allocations, {} deallocations, {} locks\n",
+                block.sampleIndex, static_cast<double>(block.sampleIndex) / sampleRate,
+                block.counts[0], block.counts[1], block.counts[2]
+            );
+        }
+    }
+
+    return text;
+}
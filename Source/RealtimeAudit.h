@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+/**
+ * Counts the operations that aren't real-time safe which a plugin performs inside processBlock:
+ * allocating or freeing memory and locking mutexes.
+ *
+ * The operations are caught by hooks replacing the global operator new and delete, malloc and its
+ * relatives, and pthread_mutex_lock. The hooks only count operations on a thread while it's inside
+ * a ScopedProcessBlock, so the host's own allocations and the other threads aren't reported.
+ * They're only available on Linux, in builds with the PLUGALYZER_REALTIME_AUDIT option enabled.
+ */
+class RealtimeAudit {
+  public:
+    enum class Violation { allocation, deallocation, lock };
+    static constexpr std::size_t numViolationTypes = 3;
+    static constexpr std::size_t numWorstBlocks = 10;
+
+    /* The violations counted during a single processBlock call */
+    struct BlockReport {
+        // position of the block's first sample in the render
+        std::size_t sampleIndex{ 0 };
+        std::array<std::size_t, numViolationTypes> counts{};
+
+        std::size_t getNumViolations() const;
+    };
+
+    /**
+     * Counts the violations on the calling thread from its construction to its destruction,
+     * and adds them to the audit as a single processBlock call.
+     * Does nothing if no audit is given, so it can be left in place when auditing is disabled.
+     */
+    class ScopedProcessBlock {
+      public:
+        ScopedProcessBlock(RealtimeAudit* auditToUpdate, std::size_t sampleIndex);
+        ~ScopedProcessBlock();
+
+        ScopedProcessBlock(const ScopedProcessBlock&) = delete;
+        ScopedProcessBlock& operator=(const ScopedProcessBlock&) = delete;
+
+      private:
+        RealtimeAudit* audit;
+        BlockReport report;
+    };
+
+    /**
+     * @return Whether the hooks have been built into this executable.
+     */
+    static bool isSupported();
+
+    /**
+     * @param sampleRate The sample rate of the render, for reporting the time of the blocks.
+     */
+    explicit RealtimeAudit(double sampleRate);
+
+    std::size_t getNumViolations() const;
+    std::string toString() const;
+
+  private:
+    // Must not allocate, since it's called on the render thread
+    void addBlock(const BlockReport& report);
+
+    double sampleRate;
+    std::size_t numBlocks{ 0 };
+    std::size_t numBlocksWithViolations{ 0 };
+    std::array<std::size_t, numViolationTypes> totalCounts{};
+    // the blocks with the most violations, sorted in descending order
+    std::array<BlockReport, numWorstBlocks> worstBlocks{};
+    std::size_t numWorstBlocksFound{ 0 };
+};
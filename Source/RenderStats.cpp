@@ -0,0 +1,252 @@
+#include "RenderStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <format>
+#include <juce_core/juce_core.h>
+#include <numeric>
+#include <optional>
+#include <string>
+
+#if JUCE_WINDOWS
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+static constexpr std::array<const char*, RenderStats::numStages> stageNames{
+    "inputRender", "midiFill", "automationApply", "processBlock", "write"
+};
+
+static double toSeconds(RenderStats::Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static double toMicroseconds(RenderStats::Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+/**
+ * @return The peak amount of physical memory used by this process in bytes,
+ * or nothing if it couldn't be determined.
+ */
+static std::optional<std::size_t> getPeakResidentSetSize() {
+#if JUCE_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<std::size_t>(counters.PeakWorkingSetSize);
+    }
+    return std::nullopt;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return std::nullopt;
+    }
+    #if JUCE_MAC
+    // reported in bytes on macOS...
+    return static_cast<std::size_t>(usage.ru_maxrss);
+    #else
+    // ...and in kilobytes everywhere else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+}
+
+std::size_t RenderStats::getBucketIndex(Clock::duration duration) {
+    const auto microseconds = toMicroseconds(duration);
+    if (microseconds < 1.0) {
+        const auto bucket =
+            static_cast<std::size_t>(std::max(microseconds, 0.0) * numBucketsPerOctave);
+        return std::min(bucket, numBucketsPerOctave - 1);
+    }
+
+    // microseconds = mantissa * 2^exponent with the mantissa in [0.5, 1),
+    // so the octave [2^(exponent - 1), 2^exponent) holds the time
+    int exponent = 0;
+    const auto mantissa = std::frexp(microseconds, &exponent);
+    const auto octave = static_cast<std::size_t>(exponent);
+    if (octave >= numOctaves) {
+        return numOctaves * numBucketsPerOctave - 1;
+    }
+    const auto bucket = static_cast<std::size_t>((mantissa - 0.5) * 2.0 * numBucketsPerOctave);
+    return octave * numBucketsPerOctave + std::min(bucket, numBucketsPerOctave - 1);
+}
+
+double RenderStats::getBucketUpperBound(std::size_t bucketIndex) {
+    const auto octave = bucketIndex / numBucketsPerOctave;
+    const auto step = static_cast<double>(bucketIndex % numBucketsPerOctave + 1) /
+                      static_cast<double>(numBucketsPerOctave);
+    if (octave == 0) {
+        return step;
+    }
+    return std::ldexp(1.0 + step, static_cast<int>(octave) - 1);
+}
+
+RenderStats::Clock::duration RenderStats::getProcessBlockPercentile(double percentile) const {
+    const auto numCalls = stageTotals[static_cast<std::size_t>(Stage::processBlock)].numCalls;
+
+    // the nearest-rank method, on the upper bound of the bucket holding that rank
+    const auto rank = std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::ceil(percentile / 100.0 * static_cast<double>(numCalls))), 1,
+        numCalls
+    );
+    std::size_t numCallsBelow = 0;
+    for (std::size_t i = 0; i < processBlockBuckets.size(); i++) {
+        numCallsBelow += processBlockBuckets[i];
+        if (numCallsBelow >= rank) {
+            const auto upperBound = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::micro>(getBucketUpperBound(i))
+            );
+            return std::min(upperBound, maxProcessBlockTime);
+        }
+    }
+    return maxProcessBlockTime;
+}
+
+void RenderStats::addTime(Stage stage, Clock::duration duration) {
+    auto& total = stageTotals[static_cast<std::size_t>(stage)];
+    total.time += duration;
+    total.numCalls++;
+
+    if (stage == Stage::processBlock) {
+        processBlockBuckets[getBucketIndex(duration)]++;
+        maxProcessBlockTime = std::max(maxProcessBlockTime, duration);
+    }
+}
+
+void RenderStats::startRender() { renderStart = Clock::now(); }
+
+void RenderStats::endRender() { wallTime = Clock::now() - renderStart; }
+
+void RenderStats::setRenderInfo(const RenderInfo& info) { renderInfo = info; }
+
+nlohmann::json RenderStats::toJson() const {
+    const auto audioDuration = static_cast<double>(renderInfo.numSamples) / renderInfo.sampleRate;
+    const auto wallTimeSeconds = toSeconds(wallTime);
+    const auto peakResidentSetSize = getPeakResidentSetSize();
+
+    nlohmann::json json{
+        { "sampleRate", renderInfo.sampleRate },
+        { "blockSize", renderInfo.blockSize },
+        { "precision", renderInfo.doublePrecision ? "double" : "single" },
+        { "pipelined", renderInfo.pipelined },
+        { "totalSamples", renderInfo.numSamples },
+        { "audioDurationSeconds", audioDuration },
+        { "wallTimeSeconds", wallTimeSeconds },
+        // how many times faster than real time the render ran
+        { "realTimeFactor", wallTimeSeconds > 0.0 ? audioDuration / wallTimeSeconds : 0.0 },
+        { "latencySamples", renderInfo.latencySamples },
+        { "tailLengthSeconds", renderInfo.tailLengthSeconds },
+        { "peakResidentSetSizeBytes", nullptr },
+        { "bytesWritten", renderInfo.numBytesWritten },
+        { "writeCalls", renderInfo.numWriteCalls },
+    };
+    if (peakResidentSetSize) {
+        json["peakResidentSetSizeBytes"] = *peakResidentSetSize;
+    }
+
+    auto& stagesJson = json["stages"];
+    for (std::size_t i = 0; i < numStages; i++) {
+        stagesJson[stageNames[i]] = {
+            { "totalSeconds", toSeconds(stageTotals[i].time) },
+            { "calls", stageTotals[i].numCalls },
+        };
+    }
+
+    const auto& processBlockTotal = stageTotals[static_cast<std::size_t>(Stage::processBlock)];
+    auto& processBlockJson = json["processBlock"];
+    processBlockJson["calls"] = processBlockTotal.numCalls;
+    processBlockJson["histogram"] = nlohmann::json::array();
+    if (processBlockTotal.numCalls == 0) {
+        return json;
+    }
+
+    // percentiles are estimated from the buckets, so they're accurate to a sixteenth of an octave
+    processBlockJson["meanMicroseconds"] =
+        toMicroseconds(processBlockTotal.time) / static_cast<double>(processBlockTotal.numCalls);
+    processBlockJson["p50Microseconds"] = toMicroseconds(getProcessBlockPercentile(50.0));
+    processBlockJson["p99Microseconds"] = toMicroseconds(getProcessBlockPercentile(99.0));
+    processBlockJson["maxMicroseconds"] = toMicroseconds(maxProcessBlockTime);
+
+    // power-of-two buckets, from below one microsecond up to the bucket holding the maximum
+    const auto lastOctave = getBucketIndex(maxProcessBlockTime) / numBucketsPerOctave;
+    for (std::size_t octave = 0; octave <= lastOctave; octave++) {
+        const auto first = processBlockBuckets.begin() +
+                           static_cast<std::ptrdiff_t>(octave * numBucketsPerOctave);
+        processBlockJson["histogram"].push_back({
+            { "upperBoundMicroseconds", std::ldexp(1.0, static_cast<int>(octave)) },
+            { "count",
+              std::accumulate(first, first + numBucketsPerOctave, std::size_t{ 0 }) },
+        });
+    }
+
+    return json;
+}
+
+std::string RenderStats::toString() const {
+    const auto json = toJson();
+
+    std::string text = "Render statistics:\n";
+    text += std::format(
+        "  Sample rate: {} Hz, block size: {} samples, {} precision{}\n",
+        json["sampleRate"].get<double>(), json["blockSize"].get<int>(),
+        json["precision"].get<std::string>(), renderInfo.pipelined ? ", pipelined" : ""
+    );
+    text += std::format(
+        "  Rendered {} samples ({:.3f} s) in {:.3f} s, {:.2f}x real time\n",
+        renderInfo.numSamples, json["audioDurationSeconds"].get<double>(),
+        json["wallTimeSeconds"].get<double>(), json["realTimeFactor"].get<double>()
+    );
+    text += std::format(
+        "  Plugin latency: {} samples, tail: {:.3f} s\n", renderInfo.latencySamples,
+        renderInfo.tailLengthSeconds
+    );
+    if (json["peakResidentSetSizeBytes"].is_null()) {
+        text += "  Peak resident set size: unknown\n";
+    } else {
+        text += std::format(
+            "  Peak resident set size: {:.1f} MiB\n",
+            json["peakResidentSetSizeBytes"].get<double>() / (1024.0 * 1024.0)
+        );
+    }
+    text += std::format(
+        "  Wrote {} bytes using {} write calls\n", renderInfo.numBytesWritten,
+        renderInfo.numWriteCalls
+    );
+
+    text += "\nTime per stage:\n";
+    for (std::size_t i = 0; i < numStages; i++) {
+        const auto numCalls = stageTotals[i].numCalls;
+        const auto totalSeconds = toSeconds(stageTotals[i].time);
+        text += std::format(
+            "  {:<16} {:>10.3f} s total {:>12.2f} us per call ({} calls)\n", stageNames[i],
+            totalSeconds, numCalls > 0 ? totalSeconds * 1e6 / static_cast<double>(numCalls) : 0.0,
+            numCalls
+        );
+    }
+
+    const auto& processBlockJson = json["processBlock"];
+    if (processBlockJson["calls"].get<std::size_t>() == 0) {
+        return text;
+    }
+
+    text += std::format(
+        "\nprocessBlock time per call: p50 {:.2f} us, p99 {:.2f} us, max {:.2f} us\n",
+        processBlockJson["p50Microseconds"].get<double>(),
+        processBlockJson["p99Microseconds"].get<double>(),
+        processBlockJson["maxMicroseconds"].get<double>()
+    );
+    for (const auto& bucket : processBlockJson["histogram"]) {
+        text += std::format(
+            "  < {:>8.0f} us: {}\n", bucket["upperBoundMicroseconds"].get<double>(),
+            bucket["count"].get<std::size_t>()
+        );
+    }
+
+    return text;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <string>
+
+/**
+ * Timing statistics of a render, collected per processing stage.
+ *
+ * Each stage must only ever be timed from a single thread, so different stages
+ * can be timed concurrently when rendering with a pipeline.
+ */
+class RenderStats {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Stage { inputRender, midiFill, automationApply, processBlock, write };
+    static constexpr std::size_t numStages = 5;
+
+    /**
+     * Measures the time from its construction to its destruction and adds it to a stage.
+     * Does nothing if no stats are given, so timing can be left in place when stats are disabled.
+     */
+    class ScopedTimer {
+      public:
+        ScopedTimer(RenderStats* statsToUpdate, Stage stageToTime)
+            : stats(statsToUpdate), stage(stageToTime),
+              start(statsToUpdate != nullptr ? Clock::now() : Clock::time_point{}) {}
+
+        ~ScopedTimer() {
+            if (stats != nullptr) {
+                stats->addTime(stage, Clock::now() - start);
+            }
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+      private:
+        RenderStats* stats;
+        Stage stage;
+        Clock::time_point start;
+    };
+
+    /* Properties of the render that are reported alongside the measurements */
+    struct RenderInfo {
+        double sampleRate{ 0.0 };
+        int blockSize{ 0 };
+        bool doublePrecision{ false };
+        bool pipelined{ false };
+        // amount of samples passed through the plugin, including latency compensation
+        std::size_t numSamples{ 0 };
+        int latencySamples{ 0 };
+        double tailLengthSeconds{ 0.0 };
+        std::size_t numBytesWritten{ 0 };
+        std::size_t numWriteCalls{ 0 };
+    };
+
+    void addTime(Stage stage, Clock::duration duration);
+
+    /* Marks the start of the render for measuring its wall time */
+    void startRender();
+    /* Marks the end of the render for measuring its wall time */
+    void endRender();
+
+    void setRenderInfo(const RenderInfo& info);
+
+    nlohmann::json toJson() const;
+    std::string toString() const;
+
+  private:
+    struct StageTotal {
+        Clock::duration time{ 0 };
+        std::size_t numCalls{ 0 };
+    };
+
+    // processBlock times are counted in buckets spanning a power of two microseconds each,
+    // subdivided linearly, so recording them never allocates no matter how many calls the
+    // render makes. The first octave holds everything below one microsecond.
+    static constexpr std::size_t numOctaves = 40;
+    static constexpr std::size_t numBucketsPerOctave = 16;
+
+    // Picks the bucket a processBlock time is counted in
+    static std::size_t getBucketIndex(Clock::duration duration);
+    // The time below which the times in a bucket lie, in microseconds
+    static double getBucketUpperBound(std::size_t bucketIndex);
+    // Estimates the time at the given percentile from the buckets, between 0 and 100
+    Clock::duration getProcessBlockPercentile(double percentile) const;
+
+    std::array<StageTotal, numStages> stageTotals;
+    std::array<std::size_t, numOctaves * numBucketsPerOctave> processBlockBuckets{};
+    Clock::duration maxProcessBlockTime{ 0 };
+    Clock::time_point renderStart;
+    Clock::duration wallTime{ 0 };
+    RenderInfo renderInfo;
+};
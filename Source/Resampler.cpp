@@ -0,0 +1,303 @@
+#include "Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+Resampler::Resampler(
+    int numChannels, double sourceSampleRate, double targetSampleRate, ResamplingQuality quality
+)
+    : speedRatio(sourceSampleRate / targetSampleRate) {
+    interpolators.reserve(static_cast<std::size_t>(numChannels));
+    for (int channel = 0; channel < numChannels; channel++) {
+        switch (quality) {
+        case ResamplingQuality::fast:
+            interpolators.emplace_back(std::in_place_type<juce::Interpolators::Linear>);
+            break;
+        case ResamplingQuality::good:
+            interpolators.emplace_back(std::in_place_type<juce::Interpolators::Lagrange>);
+            break;
+        case ResamplingQuality::best:
+            interpolators.emplace_back(std::in_place_type<juce::Interpolators::WindowedSinc>);
+            break;
+        }
+    }
+
+    const auto filterLatency =
+        createAntiAliasingFilters(numChannels, sourceSampleRate, targetSampleRate, quality);
+
+    // the interpolators lag behind the input by their base latency in input samples
+    if (!interpolators.empty()) {
+        const auto baseLatency = std::visit(
+            [](const auto& interpolator) { return interpolator.getBaseLatency(); },
+            interpolators.front()
+        );
+        latencyInOutputSamples = juce::roundToInt((baseLatency + filterLatency) / speedRatio);
+    }
+
+    inputBuffer.setSize(numChannels, 0);
+    skipBuffer.setSize(numChannels, 0);
+    reset();
+}
+
+double Resampler::createAntiAliasingFilters(
+    int numChannels, double sourceSampleRate, double targetSampleRate, ResamplingQuality quality
+) {
+    if (speedRatio <= 1.0) {
+        return 0.0;
+    }
+
+    // a Butterworth low-pass made of second order sections, whose cutoff leaves some room below
+    // the target's Nyquist frequency for the filter to roll off
+    const auto numSections = quality == ResamplingQuality::fast   ? 2
+                             : quality == ResamplingQuality::good ? 4
+                                                                  : 8;
+    const auto cutoff = targetSampleRate * 0.45;
+
+    std::vector<juce::IIRFilter> sections(static_cast<std::size_t>(numSections));
+    double latency = 0.0;
+    for (int i = 0; i < numSections; i++) {
+        const auto q = 1.0 / (2.0 * std::cos(juce::MathConstants<double>::pi * (2 * i + 1) /
+                                             (4.0 * numSections)));
+        const auto coefficients = juce::IIRCoefficients::makeLowPass(sourceSampleRate, cutoff, q);
+        sections[static_cast<std::size_t>(i)].setCoefficients(coefficients);
+
+        // the group delay at 0 Hz, which is where the section's delay is the most uniform
+        const auto* c = coefficients.coefficients;
+        latency += (c[1] + 2.0 * c[2]) / (c[0] + c[1] + c[2]) -
+                   (c[3] + 2.0 * c[4]) / (1.0 + c[3] + c[4]);
+    }
+
+    antiAliasingFilters.assign(static_cast<std::size_t>(numChannels), sections);
+    return latency;
+}
+
+void Resampler::reset() {
+    for (auto& interpolator : interpolators) {
+        std::visit([](auto& i) { i.reset(); }, interpolator);
+    }
+    for (auto& filter : antiAliasingFilters) {
+        for (auto& section : filter) {
+            section.reset();
+        }
+    }
+    numInputSamplesBuffered = 0;
+    numOutputSamplesToSkip = latencyInOutputSamples;
+}
+
+void Resampler::pushInput(const float* const* channels, int startOffset, int numSamples) {
+    const auto numSamplesNeeded = numInputSamplesBuffered + numSamples;
+    if (numSamplesNeeded > inputBuffer.getNumSamples()) {
+        inputBuffer.setSize(inputBuffer.getNumChannels(), numSamplesNeeded, true, false, true);
+    }
+
+    for (int channel = 0; channel < inputBuffer.getNumChannels(); channel++) {
+        inputBuffer.copyFrom(
+            channel, numInputSamplesBuffered, channels[channel] + startOffset, numSamples
+        );
+        if (!antiAliasingFilters.empty()) {
+            auto* samples = inputBuffer.getWritePointer(channel, numInputSamplesBuffered);
+            for (auto& section : antiAliasingFilters[static_cast<std::size_t>(channel)]) {
+                section.processSamples(samples, numSamples);
+            }
+        }
+    }
+    numInputSamplesBuffered += numSamples;
+}
+
+// interpolating n output samples consumes at most ceil(n * speedRatio) + 1 input samples,
+// depending on how far the interpolators are between two input samples
+int Resampler::getNumInputSamplesNeeded(int numOutputSamples) const {
+    const auto numSamplesToInterpolate = numOutputSamplesToSkip + numOutputSamples;
+    const auto numSamplesNeeded =
+        static_cast<int>(std::ceil(numSamplesToInterpolate * speedRatio)) + 1;
+    return std::max(0, numSamplesNeeded - numInputSamplesBuffered);
+}
+
+int Resampler::getNumOutputSamplesAvailable() const {
+    if (numInputSamplesBuffered < 1) {
+        return 0;
+    }
+    const auto numSamplesToInterpolate =
+        static_cast<int>(std::floor((numInputSamplesBuffered - 1) / speedRatio));
+    return std::max(0, numSamplesToInterpolate - numOutputSamplesToSkip);
+}
+
+int Resampler::getNumWarmUpSamples() const {
+    // the interpolators look as far back as their latency, and the anti-aliasing filter's
+    // response takes a while to decay
+    return std::max(2 * latencyInOutputSamples, 64);
+}
+
+void Resampler::pullOutput(float* const* channels, int startOffset, int numSamples) {
+    jassert(numSamples <= getNumOutputSamplesAvailable());
+
+    if (numOutputSamplesToSkip > 0) {
+        skipBuffer.setSize(skipBuffer.getNumChannels(), numOutputSamplesToSkip, false, false, true);
+        interpolate(skipBuffer.getArrayOfWritePointers(), 0, numOutputSamplesToSkip);
+        numOutputSamplesToSkip = 0;
+    }
+
+    interpolate(channels, startOffset, numSamples);
+}
+
+void Resampler::interpolate(float* const* channels, int startOffset, int numSamples) {
+    // all channels are in the same position, so they use the same amount of input
+    int numSamplesUsed = 0;
+    for (int channel = 0; channel < inputBuffer.getNumChannels(); channel++) {
+        numSamplesUsed = std::visit(
+            [&](auto& interpolator) {
+                return interpolator.process(
+                    speedRatio, inputBuffer.getReadPointer(channel),
+                    channels[channel] + startOffset, numSamples
+                );
+            },
+            interpolators[static_cast<std::size_t>(channel)]
+        );
+    }
+    jassert(numSamplesUsed <= numInputSamplesBuffered);
+
+    // move the input that's left to the front
+    const auto numSamplesLeft = numInputSamplesBuffered - numSamplesUsed;
+    for (int channel = 0; channel < inputBuffer.getNumChannels(); channel++) {
+        auto* samples = inputBuffer.getWritePointer(channel);
+        std::copy(samples + numSamplesUsed, samples + numInputSamplesBuffered, samples);
+    }
+    numInputSamplesBuffered = numSamplesLeft;
+}
+
+ResamplingAudioFormatReader::ResamplingAudioFormatReader(
+    std::unique_ptr<juce::AudioFormatReader> sourceReader, double targetSampleRate,
+    ResamplingQuality quality
+)
+    : AudioFormatReader(nullptr, sourceReader->getFormatName()), source(std::move(sourceReader)),
+      resampler(
+          static_cast<int>(source->numChannels), source->sampleRate, targetSampleRate, quality
+      ) {
+    sampleRate = targetSampleRate;
+    bitsPerSample = source->bitsPerSample;
+    numChannels = source->numChannels;
+    usesFloatingPointData = true;
+    // a length of zero means that it's unknown
+    lengthInSamples = static_cast<juce::int64>(
+        std::ceil(static_cast<double>(source->lengthInSamples) * targetSampleRate /
+                  source->sampleRate)
+    );
+}
+
+bool ResamplingAudioFormatReader::readSamples(
+    int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+    juce::int64 startSampleInFile, int numSamples
+) {
+    const auto numSourceChannels = static_cast<int>(numChannels);
+
+    if (startSampleInFile != nextSamplePosition) {
+        // start over from a bit earlier in the source and discard the output up to the
+        // requested position, so the resampler has warmed up by the time it gets there
+        resampler.reset();
+        const auto warmUpStart =
+            std::max<juce::int64>(0, startSampleInFile - resampler.getNumWarmUpSamples());
+        sourcePosition = static_cast<juce::int64>(
+            std::llround(static_cast<double>(warmUpStart) * source->sampleRate / sampleRate)
+        );
+        if (!resampleNext(static_cast<int>(startSampleInFile - warmUpStart))) {
+            return false;
+        }
+    }
+    nextSamplePosition = startSampleInFile + numSamples;
+
+    if (!resampleNext(numSamples)) {
+        return false;
+    }
+
+    // the samples are floats, since usesFloatingPointData is set
+    for (int channel = 0; channel < numDestChannels; channel++) {
+        if (destChannels[channel] == nullptr) {
+            continue;
+        }
+        auto* dest = reinterpret_cast<float*>(destChannels[channel]) + startOffsetInDestBuffer;
+        if (channel < numSourceChannels) {
+            const auto* samples = outputBuffer.getReadPointer(channel);
+            std::copy(samples, samples + numSamples, dest);
+        } else {
+            std::fill(dest, dest + numSamples, 0.0f);
+        }
+    }
+
+    return true;
+}
+
+bool ResamplingAudioFormatReader::resampleNext(int numSamples) {
+    const auto numSourceChannels = static_cast<int>(numChannels);
+
+    if (const auto numSourceSamples = resampler.getNumInputSamplesNeeded(numSamples);
+        numSourceSamples > 0) {
+        sourceBuffer.setSize(numSourceChannels, numSourceSamples, false, false, true);
+        if (!source->read(
+                sourceBuffer.getArrayOfWritePointers(), numSourceChannels, sourcePosition,
+                numSourceSamples
+            )) {
+            return false;
+        }
+        resampler.pushInput(sourceBuffer.getArrayOfReadPointers(), 0, numSourceSamples);
+        sourcePosition += numSourceSamples;
+    }
+
+    outputBuffer.setSize(numSourceChannels, numSamples, false, false, true);
+    resampler.pullOutput(outputBuffer.getArrayOfWritePointers(), 0, numSamples);
+    return true;
+}
+
+juce::AudioChannelSet ResamplingAudioFormatReader::getChannelLayout() {
+    return source->getChannelLayout();
+}
+
+ResamplingAudioFormatWriter::ResamplingAudioFormatWriter(
+    std::unique_ptr<juce::AudioFormatWriter> destinationWriter, double sourceSampleRate,
+    ResamplingQuality quality
+)
+    : AudioFormatWriter(
+          nullptr, destinationWriter->getFormatName(), sourceSampleRate,
+          static_cast<unsigned int>(destinationWriter->getNumChannels()),
+          static_cast<unsigned int>(destinationWriter->getBitsPerSample())
+      ),
+      destination(std::move(destinationWriter)),
+      resampler(
+          destination->getNumChannels(), sourceSampleRate, destination->getSampleRate(), quality
+      ) {
+    usesFloatingPointData = true;
+}
+
+ResamplingAudioFormatWriter::~ResamplingAudioFormatWriter() {
+    // the last output samples are interpolated from silence after the end of the input
+    const auto numOutputSamplesTotal = static_cast<juce::int64>(std::llround(
+        static_cast<double>(numInputSamples) * destination->getSampleRate() / sampleRate
+    ));
+    const auto numOutputSamplesLeft = static_cast<int>(numOutputSamplesTotal - numOutputSamples);
+    if (numOutputSamplesLeft > 0) {
+        const auto numSilentSamples = resampler.getNumInputSamplesNeeded(numOutputSamplesLeft);
+        juce::AudioBuffer<float> silence{ static_cast<int>(numChannels), numSilentSamples };
+        silence.clear();
+        resampler.pushInput(silence.getArrayOfReadPointers(), 0, numSilentSamples);
+        writeOutput(numOutputSamplesLeft);
+    }
+}
+
+bool ResamplingAudioFormatWriter::write(const int** samplesToWrite, int numSamples) {
+    // the samples are floats, since usesFloatingPointData is set
+    resampler.pushInput(reinterpret_cast<const float* const*>(samplesToWrite), 0, numSamples);
+    numInputSamples += numSamples;
+    return writeOutput(resampler.getNumOutputSamplesAvailable());
+}
+
+bool ResamplingAudioFormatWriter::writeOutput(int numOutputSamplesToWrite) {
+    if (numOutputSamplesToWrite <= 0) {
+        return true;
+    }
+
+    outputBuffer.setSize(
+        static_cast<int>(numChannels), numOutputSamplesToWrite, false, false, true
+    );
+    resampler.pullOutput(outputBuffer.getArrayOfWritePointers(), 0, numOutputSamplesToWrite);
+    numOutputSamples += numOutputSamplesToWrite;
+    return destination->writeFromAudioSampleBuffer(outputBuffer, 0, numOutputSamplesToWrite);
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+/* Trade-offs between speed and quality when converting sample rates */
+enum class ResamplingQuality { fast, good, best };
+
+inline const std::unordered_map<std::string, ResamplingQuality> resamplingQualityMap{
+    { "fast", ResamplingQuality::fast },
+    { "good", ResamplingQuality::good },
+    { "best", ResamplingQuality::best },
+};
+
+/**
+ * Converts the sample rate of multichannel audio in a single pass, for audio that's read or
+ * written block by block. Input is buffered until there's enough of it to produce the requested
+ * output, and every input sample only has to be pushed once.
+ *
+ * When downsampling, the input is low-pass filtered before it's interpolated, since the
+ * interpolators don't filter out what's above the target sample rate's Nyquist frequency, which
+ * would alias otherwise.
+ *
+ * The latency of the interpolators and the filter is compensated for, so the output lines up
+ * with the input to within half an output sample.
+ */
+class Resampler {
+  public:
+    /**
+     * @param numChannels The amount of channels to resample.
+     * @param sourceSampleRate The sample rate of the input.
+     * @param targetSampleRate The sample rate of the output.
+     * @param quality Linear interpolation when fast, Lagrange interpolation when good,
+     * and windowed sinc interpolation when best. Higher qualities also use a steeper
+     * anti-aliasing filter when downsampling.
+     */
+    Resampler(
+        int numChannels, double sourceSampleRate, double targetSampleRate,
+        ResamplingQuality quality
+    );
+
+    /**
+     * Discards the buffered input and the interpolators' state, to start over from a new
+     * position.
+     */
+    void reset();
+
+    /**
+     * Appends samples to the input.
+     *
+     * @param channels The samples of each channel.
+     * @param startOffset The position of the first sample to push in each channel.
+     * @param numSamples The amount of samples to push.
+     */
+    void pushInput(const float* const* channels, int startOffset, int numSamples);
+
+    /**
+     * @param numOutputSamples The amount of output samples to produce.
+     * @return The amount of input samples that have to be pushed before they can be produced.
+     */
+    int getNumInputSamplesNeeded(int numOutputSamples) const;
+
+    /**
+     * @return The amount of output samples that can be produced from the buffered input.
+     */
+    int getNumOutputSamplesAvailable() const;
+
+    /**
+     * @return The amount of output samples after a reset that differ from what they'd be without
+     * the reset, since the interpolators and filter are missing the input before it.
+     */
+    int getNumWarmUpSamples() const;
+
+    /**
+     * Produces output samples, consuming the input they're interpolated from.
+     *
+     * @param channels The channels to write the output to.
+     * @param startOffset The position in each channel to write the first sample to.
+     * @param numSamples The amount of samples to produce. Must be available.
+     */
+    void pullOutput(float* const* channels, int startOffset, int numSamples);
+
+  private:
+    using Interpolator = std::variant<
+        juce::Interpolators::Linear, juce::Interpolators::Lagrange,
+        juce::Interpolators::WindowedSinc>;
+
+    // Sets up the anti-aliasing filter for downsampling and returns its latency in input samples
+    double createAntiAliasingFilters(
+        int numChannels, double sourceSampleRate, double targetSampleRate,
+        ResamplingQuality quality
+    );
+    // Interpolates output samples from the buffered input and consumes it
+    void interpolate(float* const* channels, int startOffset, int numSamples);
+
+    // input samples per output sample
+    double speedRatio;
+    std::vector<Interpolator> interpolators;
+    // the sections of each channel's low-pass filter, empty unless downsampling
+    std::vector<std::vector<juce::IIRFilter>> antiAliasingFilters;
+    // output samples that are still to be discarded to make up for the interpolators' latency
+    int numOutputSamplesToSkip{ 0 };
+    int latencyInOutputSamples{ 0 };
+
+    juce::AudioBuffer<float> inputBuffer;
+    int numInputSamplesBuffered{ 0 };
+    juce::AudioBuffer<float> skipBuffer;
+};
+
+/**
+ * Reads another reader's audio at a different sample rate, converting it while reading.
+ *
+ * Reading is fastest when blocks are read in order, since the source is then read in a single
+ * pass. Reading from anywhere else starts over from a little before the corresponding position
+ * in the source, so the resampler has warmed up and the samples match the ones read in order.
+ */
+class ResamplingAudioFormatReader : public juce::AudioFormatReader {
+  public:
+    /**
+     * @param sourceReader The reader to resample.
+     * @param targetSampleRate The sample rate to read the audio at.
+     * @param quality The resampling quality.
+     */
+    ResamplingAudioFormatReader(
+        std::unique_ptr<juce::AudioFormatReader> sourceReader, double targetSampleRate,
+        ResamplingQuality quality
+    );
+
+    bool readSamples(
+        int* const* destChannels, int numDestChannels, int startOffsetInDestBuffer,
+        juce::int64 startSampleInFile, int numSamples
+    ) override;
+    juce::AudioChannelSet getChannelLayout() override;
+
+  private:
+    // Resamples the next samples of the source into the output buffer
+    bool resampleNext(int numSamples);
+
+    std::unique_ptr<juce::AudioFormatReader> source;
+    Resampler resampler;
+    // position in the source of the next sample to push into the resampler
+    juce::int64 sourcePosition{ 0 };
+    // position of the next sample if blocks are read in order
+    juce::int64 nextSamplePosition{ 0 };
+    juce::AudioBuffer<float> sourceBuffer;
+    juce::AudioBuffer<float> outputBuffer;
+};
+
+/**
+ * Converts the sample rate of the audio written to another writer.
+ * The remaining output is written when the writer is destroyed.
+ */
+class ResamplingAudioFormatWriter : public juce::AudioFormatWriter {
+  public:
+    /**
+     * @param destinationWriter The writer to write the resampled audio to. Its sample rate is
+     * the target sample rate.
+     * @param sourceSampleRate The sample rate of the audio written to this writer.
+     * @param quality The resampling quality.
+     */
+    ResamplingAudioFormatWriter(
+        std::unique_ptr<juce::AudioFormatWriter> destinationWriter, double sourceSampleRate,
+        ResamplingQuality quality
+    );
+    ~ResamplingAudioFormatWriter() override;
+
+    bool write(const int** samplesToWrite, int numSamples) override;
+
+  private:
+    // Produces the given amount of output from the buffered input and writes it
+    bool writeOutput(int numOutputSamplesToWrite);
+
+    std::unique_ptr<juce::AudioFormatWriter> destination;
+    Resampler resampler;
+    juce::int64 numInputSamples{ 0 };
+    juce::int64 numOutputSamples{ 0 };
+    juce::AudioBuffer<float> outputBuffer;
+};
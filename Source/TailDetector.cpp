@@ -0,0 +1,28 @@
+#include "TailDetector.h"
+
+#include <algorithm>
+
+TailDetector::TailDetector(double threshold, std::size_t windowLength, std::size_t maxLength)
+    : threshold(threshold), windowLength(std::max<std::size_t>(windowLength, 1)),
+      maxLength(maxLength) {
+    if (maxLength == 0) {
+        ended = true;
+    }
+}
+
+void TailDetector::advance(int numLoud, int numSamples) {
+    if (numLoud > 0) {
+        loudEnd = position + static_cast<std::size_t>(numLoud);
+    }
+    position += static_cast<std::size_t>(numSamples);
+
+    if (position - loudEnd >= windowLength || position >= maxLength) {
+        ended.store(true, std::memory_order_release);
+    }
+}
+
+bool TailDetector::hasEnded() const { return ended.load(std::memory_order_acquire); }
+
+std::size_t TailDetector::getWindowLength() const { return windowLength; }
+
+std::size_t TailDetector::getLength() const { return loudEnd; }
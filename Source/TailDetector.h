@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+/**
+ * Finds the end of a plugin's tail, the output it keeps producing after its input has ended.
+ *
+ * The tail is fed in order as it's rendered. It has ended once the output has stayed at or below
+ * the threshold for the length of the window, or once it has reached its maximum length.
+ * The quiet samples at its end aren't part of it, so the tail ends right after its last sample
+ * above the threshold.
+ */
+class TailDetector {
+  public:
+    /**
+     * @param threshold The linear amplitude at or below which the output counts as quiet.
+     * @param windowLength How many quiet samples in a row end the tail.
+     * @param maxLength The length after which the tail ends regardless of the output.
+     */
+    TailDetector(double threshold, std::size_t windowLength, std::size_t maxLength);
+
+    /**
+     * Analyses the next samples of the tail across the given channels.
+     * Samples past the tail's maximum length are ignored.
+     *
+     * @param buffer The rendered output.
+     * @param numChannels The amount of channels to analyse, starting from the first.
+     * @param startSample The first sample of the buffer to analyse.
+     * @param numSamples The amount of samples to analyse.
+     * @return The amount of the given samples up to and including the last one above the
+     * threshold, or zero if they're all quiet.
+     */
+    template<typename SampleType>
+    int analyse(
+        const juce::AudioBuffer<SampleType>& buffer, int numChannels, int startSample,
+        int numSamples
+    ) {
+        const auto numRemaining = maxLength - position;
+        if (static_cast<std::size_t>(numSamples) > numRemaining) {
+            numSamples = static_cast<int>(numRemaining);
+        }
+
+        int numLoud = 0;
+        for (int channel = 0; channel < numChannels; channel++) {
+            const auto* samples = buffer.getReadPointer(channel, startSample);
+            // samples before the last loud one found in other channels can't change the result
+            for (int i = numSamples - 1; i >= numLoud; i--) {
+                if (std::abs(static_cast<double>(samples[i])) > threshold) {
+                    numLoud = i + 1;
+                    break;
+                }
+            }
+        }
+
+        advance(numLoud, numSamples);
+        return numLoud;
+    }
+
+    /**
+     * Can be called from any thread.
+     *
+     * @return Whether the end of the tail has been found.
+     */
+    bool hasEnded() const;
+
+    /**
+     * @return How many quiet samples in a row end the tail.
+     */
+    std::size_t getWindowLength() const;
+
+    /**
+     * @return The length of the tail found so far in samples, excluding the quiet samples
+     * at its end.
+     */
+    std::size_t getLength() const;
+
+  private:
+    void advance(int numLoud, int numSamples);
+
+    double threshold;
+    std::size_t windowLength;
+    std::size_t maxLength;
+    // amount of tail samples analysed so far
+    std::size_t position{ 0 };
+    // position right after the last sample above the threshold
+    std::size_t loudEnd{ 0 };
+    std::atomic<bool> ended{ false };
+};
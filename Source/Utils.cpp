@@ -2,6 +2,7 @@
 
 #include "Errors.h"
 #include "Parsers.h"
+#include "PluginScanCache.h"
 
 #include <algorithm>
 #include <cctype>
@@ -10,6 +11,7 @@
 #include <iostream>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -59,59 +61,61 @@ size_t secondsToSamples(double sec, double sampleRate) { return (size_t) (sec *
 std::unique_ptr<juce::AudioPluginInstance> PluginUtils::createPluginInstance(
     const juce::String& pluginPath, double initialSampleRate, int initialBlockSize
 ) {
+    return createPluginInstance(
+        findPluginDescription(pluginPath), initialSampleRate, initialBlockSize
+    );
+}
+
+juce::PluginDescription PluginUtils::findPluginDescription(const juce::String& pluginPath) {
+    // only plugins given by path can be cached, since entries are keyed by file properties
+    std::optional<juce::File> pluginFileOpt;
+    if (juce::File::isAbsolutePath(pluginPath) && juce::File{ pluginPath }.exists()) {
+        pluginFileOpt = juce::File{ pluginPath };
+        if (auto cachedDescription = PluginScanCache::find(*pluginFileOpt)) {
+            return *cachedDescription;
+        }
+    }
+
     juce::AudioPluginFormatManager audioPluginFormatManager;
     addDefaultFormatsToManager(audioPluginFormatManager);
 
     // parse the plugin path into a PluginDescription instance
-    juce::PluginDescription pluginDescription;
-    {
-        juce::OwnedArray<juce::PluginDescription> pluginDescriptions;
-
-        juce::KnownPluginList kpl;
-        kpl.scanAndAddDragAndDroppedFiles(
-            audioPluginFormatManager, juce::StringArray(pluginPath), pluginDescriptions
-        );
+    juce::OwnedArray<juce::PluginDescription> pluginDescriptions;
 
-        // check if the requested plugin was found
-        if (pluginDescriptions.isEmpty()) {
-            throw CLIException("Invalid plugin identifier: " + pluginPath);
-        }
+    juce::KnownPluginList kpl;
+    kpl.scanAndAddDragAndDroppedFiles(
+        audioPluginFormatManager, juce::StringArray(pluginPath), pluginDescriptions
+    );
 
-        pluginDescription = *pluginDescriptions[0];
+    // check if the requested plugin was found
+    if (pluginDescriptions.isEmpty()) {
+        throw CLIException("Invalid plugin identifier: " + pluginPath);
     }
 
-    // create plugin instance
-    std::unique_ptr<juce::AudioPluginInstance> plugin;
-    {
-        juce::String err;
-        plugin = audioPluginFormatManager.createPluginInstance(
-            pluginDescription, initialSampleRate, initialBlockSize, err
-        );
-
-        if (!plugin) {
-            throw CLIException("Error creating plugin instance: " + err);
-        }
+    if (pluginFileOpt) {
+        PluginScanCache::store(*pluginFileOpt, *pluginDescriptions[0]);
     }
 
-    return plugin;
+    return *pluginDescriptions[0];
 }
 
-juce::AudioProcessorParameter* PluginUtils::getPluginParameterByName(
-    const juce::AudioPluginInstance& plugin, const std::string& parameterName
+std::unique_ptr<juce::AudioPluginInstance> PluginUtils::createPluginInstance(
+    const juce::PluginDescription& pluginDescription, double initialSampleRate,
+    int initialBlockSize
 ) {
+    juce::AudioPluginFormatManager audioPluginFormatManager;
+    addDefaultFormatsToManager(audioPluginFormatManager);
 
-    auto* paramIt = std::find_if(
-        plugin.getParameters().begin(), plugin.getParameters().end(),
-        [&parameterName](juce::AudioProcessorParameter* parameter) {
-            return parameter->getName(1024).toStdString() == parameterName;
-        }
+    juce::String err;
+    auto plugin = audioPluginFormatManager.createPluginInstance(
+        pluginDescription, initialSampleRate, initialBlockSize, err
     );
 
-    if (paramIt == plugin.getParameters().end()) {
-        throw std::runtime_error("Unknown parameter identifier '" + parameterName + "'");
+    if (!plugin) {
+        throw CLIException("Error creating plugin instance: " + err);
     }
 
-    return *paramIt;
+    return plugin;
 }
 
 bool PluginUtils::pluginSupportsSingleOutputBus(const juce::AudioPluginInstance& plugin) {
@@ -159,6 +163,33 @@ bool PluginUtils::pluginSupportsSingleOutputBus(const juce::AudioPluginInstance&
     return false;
 }
 
+ParameterIndex::ParameterIndex(const juce::AudioPluginInstance& plugin) {
+    const auto& parameters = plugin.getParameters();
+    parametersByName.reserve(static_cast<size_t>(parameters.size()));
+
+    for (auto* parameter : parameters) {
+        // emplace doesn't overwrite, so the first of several parameters sharing a name wins
+        parametersByName.emplace(parameter->getName(1024).toStdString(), parameter);
+
+        if (auto* hostedParameter =
+                dynamic_cast<juce::HostedAudioProcessorParameter*>(parameter)) {
+            parametersById.emplace(hostedParameter->getParameterID().toStdString(), parameter);
+        }
+    }
+}
+
+juce::AudioProcessorParameter* ParameterIndex::get(const std::string& nameOrId) const {
+    if (auto it = parametersByName.find(nameOrId); it != parametersByName.end()) {
+        return it->second;
+    }
+
+    if (auto it = parametersById.find(nameOrId); it != parametersById.end()) {
+        return it->second;
+    }
+
+    throw std::runtime_error("Unknown parameter identifier '" + nameOrId + "'");
+}
+
 void loadPluginStateFromFile(
     juce::AudioPluginInstance& plugin, const juce::File& statePath, juce::MemoryBlock& state
 ) {
@@ -24,6 +24,23 @@ inline const std::unordered_map<std::string, OutputFormat> formatMap{
     { "xml", OutputFormat::xml },
 };
 
+/* Formats of the audio file written by the process command */
+enum class AudioFileFormat { wav, w64, raw, flac };
+
+inline const std::unordered_map<std::string, AudioFileFormat> audioFileFormatMap{
+    { "wav", AudioFileFormat::wav },
+    { "w64", AudioFileFormat::w64 },
+    { "raw", AudioFileFormat::raw },
+    { "flac", AudioFileFormat::flac },
+};
+
+// The format implied by an audio file's extension, when no format is given explicitly
+inline const std::unordered_map<std::string, AudioFileFormat> audioFileExtensionMap{
+    { ".wav", AudioFileFormat::wav },  { ".rf64", AudioFileFormat::wav },
+    { ".w64", AudioFileFormat::w64 },  { ".raw", AudioFileFormat::raw },
+    { ".f32", AudioFileFormat::raw },  { ".flac", AudioFileFormat::flac },
+};
+
 template<typename T>
 concept EqualityComparable = requires(const T& a, const T& b) {
     { a == b } -> std::convertible_to<bool>;
@@ -164,20 +181,53 @@ class PluginUtils {
     );
 
     /**
-     * Finds the plugin's parameter with the given name.
+     * Scans the plugin at the given path without instantiating it.
      *
-     * @param plugin The plugin.
-     * @param parameterName The parameter name.
-     * @return The parameter.
-     * @throws std::runtime_error If the plugin has no parameter with the given name.
+     * @param pluginPath The plugin's file path.
+     * @return The description of the plugin, from which instances can be created.
+     * @throws CLIException If no plugin was found at the path.
+     */
+    static juce::PluginDescription findPluginDescription(const juce::String& pluginPath);
+
+    /**
+     * Creates and initializes an instance of an already scanned plugin.
+     *
+     * @param pluginDescription The plugin's description.
+     * @param initialSampleRate The sample rate to initialize the plugin with.
+     * @param initialBlockSize The buffer size to initialize the plugin with.
+     * @return The initialized plugin.
      */
-    static juce::AudioProcessorParameter* getPluginParameterByName(
-        const juce::AudioPluginInstance& plugin, const std::string& parameterName
+    static std::unique_ptr<juce::AudioPluginInstance> createPluginInstance(
+        const juce::PluginDescription& pluginDescription, double initialSampleRate,
+        int initialBlockSize
     );
 
     static bool pluginSupportsSingleOutputBus(const juce::AudioPluginInstance& plugin);
 };
 
+/**
+ * Hash index of a plugin's parameters, for looking up parameters by name or ID
+ * without scanning all of the plugin's parameters.
+ */
+class ParameterIndex {
+  public:
+    explicit ParameterIndex(const juce::AudioPluginInstance& plugin);
+
+    /**
+     * Finds the parameter with the given name or, if no parameter has that name,
+     * the parameter with the given ID.
+     *
+     * @param nameOrId The parameter name or ID.
+     * @return The parameter.
+     * @throws std::runtime_error If the plugin has no parameter with the given name or ID.
+     */
+    juce::AudioProcessorParameter* get(const std::string& nameOrId) const;
+
+  private:
+    std::unordered_map<std::string, juce::AudioProcessorParameter*> parametersByName;
+    std::unordered_map<std::string, juce::AudioProcessorParameter*> parametersById;
+};
+
 /**
  * Loads a saved plugin state from file and applies it to the plugin.
  * The state should have been saved as binary using the manage state command.
@@ -1,6 +1,8 @@
 #include "Validators.h"
 
+#include "AudioStreams.h"
 #include "Parsers.h"
+#include "Resampler.h"
 #include "Utils.h"
 
 #include <cstddef>
@@ -26,6 +28,13 @@ std::string outputPath(const std::string& arg) {
     return std::string();
 }
 
+std::string existingFileOrStdin(const std::string& arg) {
+    if (arg == standardStreamPath || parse::stringToFile(arg).existsAsFile()) {
+        return std::string();
+    }
+    return std::format("File does not exist: {}", arg);
+}
+
 std::string binaryOrXml(const std::string& arg) {
     if (arg == "binary" || arg == "xml") {
         return std::string();
@@ -34,6 +43,14 @@ std::string binaryOrXml(const std::string& arg) {
     }
 }
 
+std::string textOrJson(const std::string& arg) {
+    if (arg == "text" || arg == "json") {
+        return std::string();
+    } else {
+        return "Output format must be 'text' or 'json'";
+    }
+}
+
 std::string pluginParameter(const std::string& str) {
     try {
         parse::pluginParameterArgument(str);
@@ -66,6 +83,30 @@ std::string outputFormat(const std::string& str) {
     }
 }
 
+std::string streamFormat(const std::string& str) {
+    if (streamFormatMap.contains(str)) {
+        return "";
+    } else {
+        return "Unknown stream format. Must be wav, s16le, s24le, s32le or f32le";
+    }
+}
+
+std::string audioFileFormat(const std::string& str) {
+    if (audioFileFormatMap.contains(str)) {
+        return "";
+    } else {
+        return "Unknown audio file format. Must be wav, w64, raw or flac";
+    }
+}
+
+std::string resamplingQuality(const std::string& str) {
+    if (resamplingQualityMap.contains(str)) {
+        return "";
+    } else {
+        return "Unknown resampling quality. Must be fast, good or best";
+    }
+}
+
 std::string generator(const std::string& str) {
     auto generatorJson = getJson(str);
     std::vector<std::string> errors;
@@ -129,4 +170,25 @@ std::string amplitude(const std::string& str) {
     return "";
 }
 
+std::string duration(const std::string& str) {
+    try {
+        auto [value, unit] = parse::numberAndUnits<double>(str);
+        const auto lowerUnit = string_utils::lowerCase(unit);
+        if (unit != "" && lowerUnit != "s" && lowerUnit != "ms") {
+            return "If units are provided, they must be s or ms, e.g. '1.5s' or '250ms'";
+        }
+        if (value < 0.0) {
+            return std::format("Durations can't be negative: {}", str);
+        }
+    } catch (const std::invalid_argument& e) {
+        return std::format("Can't get a number from: {}, error: {}", str, e.what());
+    } catch (const std::out_of_range& e) {
+        return std::format("Number too large: {}, error: {}", str, e.what());
+    } catch (const std::exception& e) {
+        return std::format("Couldn't parse: {}, error: {}", str, e.what());
+    }
+
+    return "";
+}
+
 } // namespace validate
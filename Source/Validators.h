@@ -19,6 +19,14 @@ namespace validate {
  */
 std::string outputPath(const std::string& arg);
 
+/**
+ * Validates that an input file exists, unless the path is "-", which stands for stdin.
+ *
+ * @param arg The file path to validate
+ * @return Empty string if valid, or an error message
+ */
+std::string existingFileOrStdin(const std::string& arg);
+
 /**
  * Validates that the passed argument is either 'binary' or 'xml'.
  * You can use this as a non-mutating validator for the CLI option->check() function
@@ -28,6 +36,15 @@ std::string outputPath(const std::string& arg);
  */
 std::string binaryOrXml(const std::string& arg);
 
+/**
+ * Validates that the passed argument is either 'text' or 'json'.
+ * You can use this as a non-mutating validator for the CLI option->check() function
+ *
+ * @param arg The argument
+ * @return Empty string if valid, or an error message
+ */
+std::string textOrJson(const std::string& arg);
+
 /**
  * Validates the format of a plugin parameter passed via CLI to be "<key>:<value>".
  * This does not validate if the parameter exists on a plugin.
@@ -53,6 +70,30 @@ std::string bitDepth(const std::string& str);
  */
 std::string outputFormat(const std::string& str);
 
+/**
+ * Validates the choice of format for audio streamed through stdin or stdout.
+ *
+ * @param str The format argument
+ * @return Empty string if valid, or an error message
+ */
+std::string streamFormat(const std::string& str);
+
+/**
+ * Validates the choice of format for output audio files.
+ *
+ * @param str The format argument
+ * @return Empty string if valid, or an error message
+ */
+std::string audioFileFormat(const std::string& str);
+
+/**
+ * Validates the choice of resampling quality.
+ *
+ * @param str The quality argument
+ * @return Empty string if valid, or an error message
+ */
+std::string resamplingQuality(const std::string& str);
+
 /**
  * Validates the necessary keys are present in the json description of a generator.
  * Does not validate the values.
@@ -71,4 +112,13 @@ std::string generator(const std::string& str);
  */
 std::string amplitude(const std::string& str);
 
+/**
+ * Validates a non-negative length of time.
+ * Can be in seconds, or with an s or ms suffix.
+ *
+ * @param str The duration argument
+ * @return Empty string if valid, or an error message
+ */
+std::string duration(const std::string& str);
+
 } // namespace validate
\ No newline at end of file
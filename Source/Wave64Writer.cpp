@@ -0,0 +1,65 @@
+#include "Wave64Writer.h"
+
+#include <array>
+#include <cstdint>
+
+using Guid = std::array<std::uint8_t, 16>;
+
+// chunks are identified by GUIDs, which start with the corresponding RIFF chunk ID
+static constexpr Guid riffGuid{ 0x72, 0x69, 0x66, 0x66, 0x2e, 0x91, 0xcf, 0x11, 0xa5, 0xd6, 0x28,
+    0xdb, 0x04, 0xc1, 0x00, 0x00 };
+static constexpr Guid waveGuid{ 0x77, 0x61, 0x76, 0x65, 0xf3, 0xac, 0xd3, 0x11, 0x8c, 0xd1, 0x00,
+    0xc0, 0x4f, 0x8e, 0xdb, 0x8a };
+static constexpr Guid fmtGuid{ 0x66, 0x6d, 0x74, 0x20, 0xf3, 0xac, 0xd3, 0x11, 0x8c, 0xd1, 0x00,
+    0xc0, 0x4f, 0x8e, 0xdb, 0x8a };
+static constexpr Guid dataGuid{ 0x64, 0x61, 0x74, 0x61, 0xf3, 0xac, 0xd3, 0x11, 0x8c, 0xd1, 0x00,
+    0xc0, 0x4f, 0x8e, 0xdb, 0x8a };
+
+// chunk sizes include the chunk's GUID and size
+static constexpr juce::int64 chunkHeaderSize = 24;
+static constexpr juce::int64 fmtChunkSize = chunkHeaderSize + 16;
+// offsets of the sizes to fill in, relative to the start of the header
+static constexpr juce::int64 riffSizeOffset = 16;
+static constexpr juce::int64 dataSizeOffset = 16 + 8 + 16 + fmtChunkSize + 16;
+static constexpr juce::int64 headerSize = dataSizeOffset + 8;
+
+Wave64Writer::Wave64Writer(
+    juce::OutputStream* destStream, double fileSampleRate, unsigned int numFileChannels,
+    PcmEncoding encoding
+)
+    : PcmStreamWriter(destStream, fileSampleRate, numFileChannels, encoding, false),
+      headerPosition(destStream->getPosition()) {
+    const auto bytesPerFrame = static_cast<int>(numChannels * bitsPerSample / 8);
+
+    output->write(riffGuid.data(), riffGuid.size());
+    output->writeInt64(0);
+    output->write(waveGuid.data(), waveGuid.size());
+
+    output->write(fmtGuid.data(), fmtGuid.size());
+    output->writeInt64(fmtChunkSize);
+    output->writeShort(encoding.floatingPoint ? 3 : 1);
+    output->writeShort(static_cast<short>(numChannels));
+    output->writeInt(static_cast<int>(sampleRate));
+    output->writeInt(static_cast<int>(sampleRate) * bytesPerFrame);
+    output->writeShort(static_cast<short>(bytesPerFrame));
+    output->writeShort(static_cast<short>(bitsPerSample));
+
+    output->write(dataGuid.data(), dataGuid.size());
+    output->writeInt64(0);
+}
+
+Wave64Writer::~Wave64Writer() {
+    const auto dataSize = output->getPosition() - headerPosition - headerSize;
+
+    // chunks are aligned to 8 bytes
+    output->writeRepeatedByte(0, static_cast<std::size_t>((8 - dataSize % 8) % 8));
+    const auto fileSize = output->getPosition() - headerPosition;
+
+    if (output->setPosition(headerPosition + riffSizeOffset)) {
+        output->writeInt64(fileSize);
+    }
+    if (output->setPosition(headerPosition + dataSizeOffset)) {
+        output->writeInt64(chunkHeaderSize + dataSize);
+    }
+    output->flush();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "AudioStreams.h"
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+/**
+ * Writes Sony Wave64 files, which are like WAV files but with 64-bit chunk sizes,
+ * so they can hold more than 4 GB of samples.
+ *
+ * The header is written with empty sizes first, and the sizes are filled in once the writer
+ * is destroyed, so the stream must support seeking.
+ */
+class Wave64Writer : public PcmStreamWriter {
+  public:
+    /**
+     * @param destStream The stream to write to, which is owned by the writer.
+     * @param sampleRate The sample rate of the file.
+     * @param numChannels The amount of interleaved channels.
+     * @param encoding How to encode the samples. Supports 8 to 32 bit integers and 32 bit
+     * floats.
+     */
+    Wave64Writer(
+        juce::OutputStream* destStream, double sampleRate, unsigned int numChannels,
+        PcmEncoding encoding
+    );
+    ~Wave64Writer() override;
+
+  private:
+    // where the header starts in the stream
+    juce::int64 headerPosition;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * Distributes a fixed set of work items among a number of workers.
+ *
+ * Every worker takes items from the front of its own queue. Once that runs dry,
+ * it steals items from the back of the other workers' queues, so workers that
+ * happen to get quick items don't sit idle while others still have work left.
+ * All items have to be pushed before the workers start popping.
+ */
+template<typename T>
+class WorkStealingQueue {
+  public:
+    explicit WorkStealingQueue(std::size_t numWorkers) : queues(numWorkers) {}
+
+    /**
+     * Adds an item to the given worker's queue.
+     */
+    void push(std::size_t worker, T item) { queues[worker].items.push_back(std::move(item)); }
+
+    /**
+     * Takes the next item for the given worker, stealing from other workers if its own queue
+     * is empty.
+     *
+     * @param worker The worker index.
+     * @return The item, or nothing if all queues are empty.
+     */
+    std::optional<T> pop(std::size_t worker) {
+        if (auto item = takeFront(queues[worker])) {
+            return item;
+        }
+
+        for (std::size_t offset = 1; offset < queues.size(); offset++) {
+            if (auto item = takeBack(queues[(worker + offset) % queues.size()])) {
+                return item;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<T> items;
+    };
+
+    static std::optional<T> takeFront(WorkerQueue& queue) {
+        std::scoped_lock lock{ queue.mutex };
+        if (queue.items.empty()) {
+            return std::nullopt;
+        }
+
+        auto item = std::move(queue.items.front());
+        queue.items.pop_front();
+        return item;
+    }
+
+    static std::optional<T> takeBack(WorkerQueue& queue) {
+        std::scoped_lock lock{ queue.mutex };
+        if (queue.items.empty()) {
+            return std::nullopt;
+        }
+
+        auto item = std::move(queue.items.back());
+        queue.items.pop_back();
+        return item;
+    }
+
+    std::vector<WorkerQueue> queues;
+};
@@ -3,67 +3,579 @@
 #include "Errors.h"
 #include "Parsers.h"
 #include "Validators.h"
+#include "WorkStealingQueue.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <format>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <print>
+#include <set>
+#include <thread>
 
+static double toSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
 
 std::shared_ptr<CLI::App> AudioDiffCommand::createApp() {
     // clang-format off
-    std::shared_ptr<CLI::App> app = std::make_shared<CLI::App>("Compares two audio files", "audioDiff");
-
-    app->add_option("-t,--test", inputFilePaths.at(AudioFileRole::test), "Audio to test")
-        ->required()
-        ->check(CLI::ExistingFile);
-    app->add_option("-r,--reference", inputFilePaths.at(AudioFileRole::reference), "Reference audio")
-        ->required()
-        ->check(CLI::ExistingFile);
+    std::shared_ptr<CLI::App> app = std::make_shared<CLI::App>("Compares two audio files, or all audio files in two directories", "audioDiff");
+
+    auto* testOption = app->add_option("-t,--test", testPath, "Audio to test, or a directory of audio to test")
+        ->check(CLI::ExistingPath);
+    auto* referenceOption = app->add_option("-r,--reference", referencePath, "Reference audio, or a directory of reference audio whose files are compared with the test files at the same relative path")
+        ->check(CLI::ExistingPath);
+    app->add_option("-m,--manifest", argManifest, "JSON string or file with an array of pairs of files to compare. Each pair is an object with a 'test' and a 'reference' path, relative to the manifest file")
+        ->excludes(testOption)
+        ->excludes(referenceOption);
     app->add_option("-d,--tolerance", argThreshold, "How different the audio can be before it's considered a failure, in RMS.")
         ->check(validate::amplitude)
         ->each([&](std::string arg){ rmsThreshold = parse::amplitude(arg); });
+    app->add_option("--sampleTolerance", argSampleTolerance, "The difference of a single sample above which it counts as divergent in the report. Defaults to the tolerance")
+        ->check(validate::amplitude)
+        ->each([&](std::string arg){ sampleToleranceOpt = parse::amplitude(arg); });
+    auto* alignOption = app->add_flag("--align", align, "Estimate the offset between the test and the reference audio by cross-correlating them, and compare them with the offset applied");
+    app->add_option("--maxOffset", maxOffset, "The largest offset in samples that --align looks for in either direction, at most 131072. Defaults to 16384")
+        ->needs(alignOption)
+        ->check(CLI::Range(juce::int64{ 0 }, AudioDiff::maxAlignmentOffset));
+    auto* spectralOption = app->add_flag("--spectral", spectral, "Compare the magnitude spectra of the audio in frequency bands instead of its samples, so phase differences don't count");
+    app->add_option("--fftSize", fftSize, "The length of the frames the spectra are computed for with --spectral. A power of two, defaults to 2048")
+        ->needs(spectralOption)
+        ->check(CLI::Range(64, 65536));
+    app->add_option("--bands", bandFrequencies, "Comma-separated frequencies in Hz at which the bands compared with --spectral start, above the first band starting at 0 Hz. Defaults to 100,500,2000,8000")
+        ->needs(spectralOption)
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+    app->add_option("--bandTolerance", argBandTolerances, "Comma-separated tolerances of the bands' magnitude errors with --spectral, one for each band or one for all of them. Defaults to the tolerance")
+        ->needs(spectralOption)
+        ->delimiter(',')
+        ->check(validate::amplitude)
+        ->each([&](std::string arg){ bandTolerances.push_back(parse::amplitude(arg)); });
+    app->add_option("-w,--workers", numThreads, "The amount of threads comparing the files in parallel. When comparing multiple pairs of files, the amount of pairs compared at once. Defaults to the number of CPU cores")
+        ->check(CLI::PositiveNumber);
+    app->add_option("-f,--format", argOutFormat, "The output format: text, only the RMS of the difference in dB (default), json, a report with all metrics per channel, or xml, a JUnit report")
+        ->check(validate::outputFormat)
+        ->each([&](std::string arg) { outputFormat = parse::outputFormat(arg); });
+    app->add_option("-o,--output", argOutPath, "Output file path for the result. Will output to stdout if not supplied.")
+        ->check(validate::outputPath)
+        ->each([&](std::string arg) { outputFilePath = parse::stringToFile(arg); });
 
     return app;
     // clang-format on
 }
 
 void AudioDiffCommand::execute() {
-    std::map<AudioFileRole, juce::File> audioFiles;
+    if (spectral) {
+        spectralBands = getSpectralBands();
+    }
 
-    for (const auto& [role, inPath] : inputFilePaths) {
-        juce::File verifiedInPath;
-        if (juce::File::isAbsolutePath(inPath)) {
-            verifiedInPath = inPath;
-        } else {
-            verifiedInPath = juce::File::getCurrentWorkingDirectory().getChildFile(inPath);
+    if (!argManifest.empty()) {
+        compareAll(parseManifest());
+        return;
+    }
+
+    if (testPath.empty() || referencePath.empty()) {
+        throw CLIException("Supply both the --test and the --reference audio, or a --manifest");
+    }
+
+    const auto test = parse::stringToFile(testPath);
+    const auto reference = parse::stringToFile(referencePath);
+    if (test.isDirectory() != reference.isDirectory()) {
+        throw CLIException("The test and the reference audio must both be files or directories");
+    }
+
+    if (test.isDirectory()) {
+        compareAll(matchDirectories(test, reference));
+    } else {
+        compareFiles({
+            .name = testPath,
+            .testPath = testPath,
+            .referencePath = referencePath,
+            .test = test,
+            .reference = reference,
+        });
+    }
+}
+
+void AudioDiffCommand::compareFiles(const FilePair& files) const {
+    const auto result = comparePair(files, static_cast<int>(numThreads));
+
+    if (!result.error.empty()) {
+        std::println(stderr, "{}", result.error);
+        throw FileLoadError("Couldn't read files. Aborting.", 2);
+    }
+
+    if (align) {
+        const auto offset = result.spectralDifference ? result.spectralDifference->testOffset
+                                                      : result.metrics->testOffset;
+        std::println(stderr, "Aligned the test audio by an offset of {} samples.", offset);
+    }
+
+    if (outputFormat == OutputFormat::xml) {
+        outputResult(getJUnitReport({ result }, result.time), outputFilePath);
+    } else if (outputFormat == OutputFormat::json) {
+        outputResult(getPairReportJson(result).dump(4), outputFilePath);
+    } else if (result.spectralDifference) {
+        outputResult(getSpectralReportText(*result.spectralDifference), outputFilePath);
+    } else {
+        outputResult(getDecibelReadout(result.metrics->rms) + "\n", outputFilePath);
+    }
+
+    if (!result.passed) {
+        std::println(stderr, "{}", getFailureMessage(result));
+        throw FailedDiffError(
+            spectral ? "Spectral comparison failed" : "Cancellation test failed", 1
+        );
+    }
+}
+
+void AudioDiffCommand::compareAll(const std::vector<FilePair>& pairs) const {
+    if (pairs.empty()) {
+        throw CLIException("There are no audio files to compare");
+    }
+
+    const auto start = Clock::now();
+
+    // every pair is compared on a single thread, which streams the files in fixed-size chunks,
+    // so the memory in use depends on the amount of workers rather than on the amount of files
+    // or their length
+    const auto numWorkers = std::min<std::size_t>(numThreads, pairs.size());
+    WorkStealingQueue<std::size_t> queue{ numWorkers };
+    for (std::size_t i = 0; i < pairs.size(); i++) {
+        queue.push(i % numWorkers, i);
+    }
+
+    // every pair writes to its own result, so workers don't need to synchronize
+    std::vector<PairResult> results(pairs.size());
+    auto work = [&](std::size_t workerIndex) {
+        while (const auto pairIndex = queue.pop(workerIndex)) {
+            results[*pairIndex] = comparePair(pairs[*pairIndex], 1);
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < numWorkers; i++) {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto time = Clock::now() - start;
+
+    if (outputFormat == OutputFormat::xml) {
+        outputResult(getJUnitReport(results, time), outputFilePath);
+    } else if (outputFormat == OutputFormat::json) {
+        outputResult(getSuiteReportJson(results, time).dump(4), outputFilePath);
+    } else {
+        outputResult(getSuiteReportText(results, time), outputFilePath);
+    }
+
+    const auto numErrors = std::ranges::count_if(results, [](const PairResult& result) {
+        return !result.error.empty();
+    });
+    const auto numFailed = std::ranges::count_if(results, [](const PairResult& result) {
+        return !result.passed;
+    });
+    if (numFailed > 0) {
+        // files that couldn't be read take precedence, like with a single pair of files
+        throw FailedDiffError(
+            std::format("{} of {} comparisons failed", numFailed, results.size()),
+            numErrors > 0 ? 2 : 1
+        );
+    }
+}
+
+std::vector<AudioDiffCommand::FilePair> AudioDiffCommand::matchDirectories(
+    const juce::File& testDirectory, const juce::File& referenceDirectory
+) const {
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    const auto wildcard = formatManager.getWildcardForAllFormats();
 
-        audioFiles.insert({ role, juce::File{ verifiedInPath } });
+    // a file missing from either directory is still paired up with the missing file,
+    // so it's reported as an error rather than silently left out
+    std::set<juce::String> relativePaths;
+    for (const auto& directory : { testDirectory, referenceDirectory }) {
+        for (const auto& file : directory.findChildFiles(juce::File::findFiles, true, wildcard)) {
+            relativePaths.insert(file.getRelativePathFrom(directory));
+        }
     }
 
-    auto differ = AudioDiff::create(audioFiles);
+    std::vector<FilePair> pairs;
+    for (const auto& relativePath : relativePaths) {
+        const auto test = testDirectory.getChildFile(relativePath);
+        const auto reference = referenceDirectory.getChildFile(relativePath);
+        pairs.push_back({
+            .name = relativePath.toStdString(),
+            .testPath = test.getFullPathName().toStdString(),
+            .referencePath = reference.getFullPathName().toStdString(),
+            .test = test,
+            .reference = reference,
+        });
+    }
+    return pairs;
+}
+
+std::vector<AudioDiffCommand::FilePair> AudioDiffCommand::parseManifest() const {
+    nlohmann::json manifest;
+    try {
+        manifest = getJson(argManifest);
+    } catch (const nlohmann::json::exception& e) {
+        throw ParseError{ std::format("Couldn't parse the manifest: {}", e.what()), 172 };
+    }
+
+    if (!manifest.is_array()) {
+        throw ParseError{ "The manifest must be a JSON array", 172 };
+    }
+
+    // paths are relative to the manifest file, or to the working directory if the manifest is
+    // supplied as a JSON string
+    const auto manifestFile = parse::stringToFile(argManifest);
+    const auto directory = manifestFile.existsAsFile()
+                               ? manifestFile.getParentDirectory()
+                               : juce::File::getCurrentWorkingDirectory();
+
+    std::vector<FilePair> pairs;
+    for (const auto& entry : manifest) {
+        if (!entry.is_object() || !entry.contains("test") || !entry["test"].is_string() ||
+            !entry.contains("reference") || !entry["reference"].is_string()) {
+            throw ParseError{
+                std::format(
+                    "Pair {} of the manifest must be an object with a 'test' and a 'reference' "
+                    "path",
+                    pairs.size() + 1
+                ),
+                172
+            };
+        }
+
+        const auto test = entry["test"].get<std::string>();
+        const auto reference = entry["reference"].get<std::string>();
+        pairs.push_back({
+            .name = test,
+            .testPath = test,
+            .referencePath = reference,
+            .test = directory.getChildFile(test),
+            .reference = directory.getChildFile(reference),
+        });
+    }
+    return pairs;
+}
+
+AudioDiffCommand::PairResult
+AudioDiffCommand::comparePair(const FilePair& files, int numPairThreads) const {
+    const auto start = Clock::now();
+    PairResult result{ .files = files };
+
+    auto differ = AudioDiff::create({
+        { AudioFileRole::test, files.test },
+        { AudioFileRole::reference, files.reference },
+    });
 
     if (!differ) {
+        juce::StringArray messages;
         for (const auto& [role, errorMessage] : differ.error()) {
-            std::println(std::cerr, "{}: {}", stringFromRole(role), errorMessage.toStdString());
+            messages.add(juce::String{ stringFromRole(role) } + ": " + errorMessage);
         }
-        throw FileLoadError("Couldn't read files. Aborting.", 2);
+        result.error = messages.joinIntoString("\n").toStdString();
+    } else {
+        if (align) {
+            differ->setTestOffset(differ->findTestOffset(maxOffset));
+        }
+
+        if (spectral) {
+            result.spectralDifference = differ->getSpectralDifference(
+                std::countr_zero(static_cast<unsigned int>(fftSize)), spectralBands,
+                numPairThreads
+            );
+            result.passed = result.spectralDifference->passed();
+        } else {
+            const auto sampleTolerance =
+                static_cast<float>(sampleToleranceOpt.value_or(rmsThreshold));
+            result.metrics = differ->getDifferenceMetrics(sampleTolerance, numPairThreads);
+            result.passed = static_cast<float>(result.metrics->rms) <= rmsThreshold;
+        }
+    }
+
+    result.time = Clock::now() - start;
+    return result;
+}
+
+std::vector<SpectralBand> AudioDiffCommand::getSpectralBands() const {
+    if (!juce::isPowerOfTwo(fftSize)) {
+        throw CLIException(std::format("The FFT size must be a power of two, not {}", fftSize));
+    }
+    if (!std::ranges::is_sorted(bandFrequencies) ||
+        std::ranges::adjacent_find(bandFrequencies) != bandFrequencies.end()) {
+        throw CLIException("The band frequencies must be in ascending order");
+    }
+
+    const auto numBands = bandFrequencies.size() + 1;
+    if (bandTolerances.size() > 1 && bandTolerances.size() != numBands) {
+        throw CLIException(std::format(
+            "Got {} band tolerances for {} bands. Supply one for each band, or one for all of them",
+            bandTolerances.size(), numBands
+        ));
     }
 
-    const auto actualRMS = differ->getDifferenceRMS();
-    const auto actualRMSdB = juce::Decibels::gainToDecibels(actualRMS, -96.f);
-    const auto actualRMSdBReadout =
-        juce::Decibels::toString(actualRMSdB, 6, -96.f, true, "-inf").toStdString();
-    const auto rmsThresholddB = juce::Decibels::gainToDecibels(rmsThreshold, -96.0);
-    const auto rmsThresholddBReadout =
-        juce::Decibels::toString(rmsThresholddB, 6, -96.0, true, "-inf").toStdString();
+    std::vector<SpectralBand> bands;
+    for (std::size_t band = 0; band < numBands; band++) {
+        bands.push_back({
+            .lowFrequency = band == 0 ? 0.0 : bandFrequencies[band - 1],
+            .tolerance = bandTolerances.empty()      ? rmsThreshold
+                         : bandTolerances.size() == 1 ? bandTolerances.front()
+                                                      : bandTolerances[band],
+        });
+    }
+    return bands;
+}
+
+std::string AudioDiffCommand::getDecibelReadout(double gain) {
+    const auto decibels = juce::Decibels::gainToDecibels(static_cast<float>(gain), -96.f);
+    return juce::Decibels::toString(decibels, 6, -96.f, true, "-inf").toStdString();
+}
+
+std::string AudioDiffCommand::getFailureMessage(const PairResult& result) const {
+    if (!result.error.empty()) {
+        return result.error;
+    }
+
+    if (result.spectralDifference) {
+        juce::StringArray messages;
+        for (const auto& band : result.spectralDifference->bands) {
+            if (!band.passed()) {
+                messages.add(std::format(
+                    "The magnitude error of {:.0f} - {:.0f} Hz exceeds its tolerance",
+                    band.lowFrequency, band.highFrequency
+                ));
+            }
+        }
+        return messages.joinIntoString("\n").toStdString();
+    }
+
+    return std::format(
+        "Detected SNR of {}, which exceeds threshold of {}", getDecibelReadout(result.metrics->rms),
+        getDecibelReadout(rmsThreshold)
+    );
+}
+
+nlohmann::json AudioDiffCommand::getPairReportJson(const PairResult& result) const {
+    nlohmann::json json;
+    if (result.spectralDifference) {
+        json = getSpectralReportJson(*result.spectralDifference);
+    } else if (result.metrics) {
+        json = getReportJson(*result.metrics);
+    } else {
+        json = { { "passed", false }, { "error", result.error } };
+    }
+
+    json["test"] = result.files.testPath;
+    json["reference"] = result.files.referencePath;
+    return json;
+}
+
+nlohmann::json AudioDiffCommand::getSuiteReportJson(
+    const std::vector<PairResult>& results, Clock::duration time
+) const {
+    nlohmann::json pairsJson = nlohmann::json::array();
+    std::size_t numPassed = 0;
+    std::size_t numErrors = 0;
+
+    for (const auto& result : results) {
+        auto pairJson = getPairReportJson(result);
+        pairJson["name"] = result.files.name;
+        pairJson["seconds"] = toSeconds(result.time);
+        pairsJson.push_back(pairJson);
+
+        numPassed += result.passed ? 1 : 0;
+        numErrors += result.error.empty() ? 0 : 1;
+    }
+
+    return {
+        { "passed", numPassed == results.size() },
+        { "pairs", results.size() },
+        { "succeeded", numPassed },
+        { "failed", results.size() - numPassed - numErrors },
+        { "errors", numErrors },
+        { "seconds", toSeconds(time) },
+        { "results", pairsJson },
+    };
+}
+
+std::string AudioDiffCommand::getSuiteReportText(
+    const std::vector<PairResult>& results, Clock::duration time
+) const {
+    std::string text;
+    std::size_t numPassed = 0;
+
+    for (const auto& result : results) {
+        numPassed += result.passed ? 1 : 0;
+
+        if (!result.error.empty()) {
+            text += std::format("ERROR   {}\n", result.files.name);
+        } else if (result.metrics) {
+            text += std::format(
+                "{:<6}  {}  {}\n", result.passed ? "passed" : "FAILED", result.files.name,
+                getDecibelReadout(result.metrics->rms)
+            );
+        } else {
+            text += std::format(
+                "{:<6}  {}\n", result.passed ? "passed" : "FAILED", result.files.name
+            );
+        }
+
+        if (!result.passed) {
+            // indented below the pair it belongs to
+            const auto message = juce::String{ getFailureMessage(result) };
+            text += ("    " + message.replace("\n", "\n    ")).toStdString() + "\n";
+        }
+    }
+
+    text += std::format(
+        "{} of {} comparisons passed in {:.3f} s\n", numPassed, results.size(), toSeconds(time)
+    );
+    return text;
+}
+
+std::string AudioDiffCommand::getJUnitReport(
+    const std::vector<PairResult>& results, Clock::duration time
+) const {
+    // every pair is a test case of a single suite. failures are pairs that differ,
+    // errors are pairs that couldn't be compared
+    juce::XmlElement suite{ "testsuite" };
+    int numFailures = 0;
+    int numErrors = 0;
+
+    for (const auto& result : results) {
+        auto* testCase = suite.createNewChildElement("testcase");
+        testCase->setAttribute("classname", "audioDiff");
+        testCase->setAttribute("name", juce::String{ result.files.name });
+        testCase->setAttribute("time", toSeconds(result.time));
+
+        if (!result.error.empty()) {
+            auto* error = testCase->createNewChildElement("error");
+            error->setAttribute("message", juce::String{ result.error });
+            numErrors++;
+        } else if (!result.passed) {
+            auto* failure = testCase->createNewChildElement("failure");
+            failure->setAttribute("message", juce::String{ getFailureMessage(result) });
+            numFailures++;
+        }
+    }
+
+    suite.setAttribute("name", "audioDiff");
+    suite.setAttribute("tests", static_cast<int>(results.size()));
+    suite.setAttribute("failures", numFailures);
+    suite.setAttribute("errors", numErrors);
+    suite.setAttribute("time", toSeconds(time));
+    return suite.toString().toStdString();
+}
+
+nlohmann::json AudioDiffCommand::getReportJson(const DifferenceMetrics& metrics) const {
+    auto toDecibels = [](double gain) { return juce::Decibels::gainToDecibels(gain, -96.0); };
+    auto toJson = [](const std::optional<juce::int64>& sampleIndex) {
+        return sampleIndex ? nlohmann::json(*sampleIndex) : nlohmann::json(nullptr);
+    };
+
+    // silence is reported as -96 dB, since JSON has no infinity
+    nlohmann::json json{
+        { "samples", metrics.numSamples },
+        { "testOffset", metrics.testOffset },
+        { "tolerance", rmsThreshold },
+        { "sampleTolerance", sampleToleranceOpt.value_or(rmsThreshold) },
+        { "passed", static_cast<float>(metrics.rms) <= rmsThreshold },
+        { "rms", metrics.rms },
+        { "rmsDecibels", toDecibels(metrics.rms) },
+        { "peak", metrics.peak },
+        { "peakDecibels", toDecibels(metrics.peak) },
+        { "firstDivergentSample", toJson(metrics.firstDivergentSample) },
+        { "samplesAboveTolerance", metrics.numSamplesAboveTolerance },
+        { "channels", nlohmann::json::array() },
+    };
+
+    for (const auto& channel : metrics.channels) {
+        json["channels"].push_back({
+            { "rms", channel.rms },
+            { "rmsDecibels", toDecibels(channel.rms) },
+            { "peak", channel.peak },
+            { "peakDecibels", toDecibels(channel.peak) },
+            { "firstDivergentSample", toJson(channel.firstDivergentSample) },
+            { "samplesAboveTolerance", channel.numSamplesAboveTolerance },
+        });
+    }
+
+    return json;
+}
+
+nlohmann::json AudioDiffCommand::getSpectralReportJson(const SpectralDifference& difference
+) const {
+    auto toDecibels = [](double gain) { return juce::Decibels::gainToDecibels(gain, -96.0); };
+
+    nlohmann::json json{
+        { "samples", difference.numSamples },
+        { "testOffset", difference.testOffset },
+        { "sampleRate", difference.sampleRate },
+        { "fftSize", difference.fftSize },
+        { "hopSize", difference.hopSize },
+        { "frames", difference.numFrames },
+        { "passed", difference.passed() },
+        { "bands", nlohmann::json::array() },
+        { "worstFrames", nlohmann::json::array() },
+    };
+
+    for (const auto& band : difference.bands) {
+        json["bands"].push_back({
+            { "lowFrequency", band.lowFrequency },
+            { "highFrequency", band.highFrequency },
+            { "tolerance", band.tolerance },
+            { "toleranceDecibels", toDecibels(band.tolerance) },
+            { "passed", band.passed() },
+            { "error", band.error },
+            { "errorDecibels", toDecibels(band.error) },
+            { "worstFrameError", band.worstFrameError },
+            { "worstFrameErrorDecibels", toDecibels(band.worstFrameError) },
+            { "worstFrameSample", band.worstFramePosition },
+            { "worstFrameSeconds", difference.toSeconds(band.worstFramePosition) },
+        });
+    }
+
+    for (const auto& frame : difference.worstFrames) {
+        nlohmann::json bandErrors = nlohmann::json::array();
+        for (const auto bandError : frame.bandErrors) {
+            bandErrors.push_back(toDecibels(bandError));
+        }
+        json["worstFrames"].push_back({
+            { "sample", frame.position },
+            { "seconds", difference.toSeconds(frame.position) },
+            { "error", frame.error },
+            { "errorDecibels", toDecibels(frame.error) },
+            { "bandErrorsDecibels", bandErrors },
+        });
+    }
+
+    return json;
+}
 
-    std::println("{}", actualRMSdBReadout);
+std::string AudioDiffCommand::getSpectralReportText(const SpectralDifference& difference) const {
+    auto toDecibels = [](double gain) {
+        const auto decibels = juce::Decibels::gainToDecibels(gain, -96.0);
+        return juce::Decibels::toString(decibels, 1, -96.0, true, "-inf").toStdString();
+    };
 
-    if (actualRMS > rmsThreshold) {
-        std::println(
-            stderr, "Detected SNR of {}, which exceeds threshold of {}", actualRMSdBReadout,
-            rmsThresholddBReadout
+    std::string text = std::format(
+        "{:>19}  {:>10}  {:>10}  {:>24}\n", "Band", "Error", "Tolerance", "Worst frame"
+    );
+    for (const auto& band : difference.bands) {
+        const auto worstFrameSeconds = difference.toSeconds(band.worstFramePosition);
+        text += std::format(
+            "{:>7.0f} - {:>6.0f} Hz  {:>10}  {:>10}  {:>10} at {:>8.3f} s  {}\n",
+            band.lowFrequency, band.highFrequency, toDecibels(band.error),
+            toDecibels(band.tolerance), toDecibels(band.worstFrameError), worstFrameSeconds,
+            band.passed() ? "passed" : "FAILED"
         );
-        throw FailedDiffError("Cancellation test failed", 1);
     }
+    return text;
 }
@@ -2,8 +2,16 @@
 
 #include "AudioDiff.h"
 #include "CLICommand.h"
+#include "Utils.h"
 
+#include <algorithm>
+#include <chrono>
 #include <juce_audio_formats/juce_audio_formats.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
 
 class FailedDiffError : public CLI::Error {
   public:
@@ -18,12 +26,86 @@ class AudioDiffCommand : public CLICommand {
     void execute() override;
 
   private:
+    using Clock = std::chrono::steady_clock;
+
+    /* A test file and the reference file it's compared with */
+    struct FilePair {
+        // the relative path the files were matched by, or the test file's path
+        std::string name;
+        // the paths as supplied, for the report
+        std::string testPath;
+        std::string referencePath;
+        juce::File test;
+        juce::File reference;
+    };
+
+    /* The result of comparing a pair of files */
+    struct PairResult {
+        FilePair files;
+        // one of these is set depending on --spectral, neither if the files couldn't be read
+        std::optional<DifferenceMetrics> metrics;
+        std::optional<SpectralDifference> spectralDifference;
+        // why the files couldn't be compared, empty if they could
+        std::string error;
+        bool passed{ false };
+        Clock::duration time{ 0 };
+    };
+
+    // Compares a single pair of files, using all workers for it
+    void compareFiles(const FilePair& files) const;
+    // Compares many pairs of files, one per worker at a time, and reports them together
+    void compareAll(const std::vector<FilePair>& pairs) const;
+    // Pairs up the audio files in two directories by their relative paths
+    std::vector<FilePair>
+    matchDirectories(const juce::File& testDirectory, const juce::File& referenceDirectory) const;
+    // Parses the manifest, throwing a ParseError if it's malformed
+    std::vector<FilePair> parseManifest() const;
+    PairResult comparePair(const FilePair& files, int numPairThreads) const;
+    // Builds the bands of the spectral comparison, throwing if the options are inconsistent
+    std::vector<SpectralBand> getSpectralBands() const;
+
+    static std::string getDecibelReadout(double gain);
+    // Explains why a pair failed
+    std::string getFailureMessage(const PairResult& result) const;
+    nlohmann::json getReportJson(const DifferenceMetrics& metrics) const;
+    nlohmann::json getSpectralReportJson(const SpectralDifference& difference) const;
+    std::string getSpectralReportText(const SpectralDifference& difference) const;
+    nlohmann::json getPairReportJson(const PairResult& result) const;
+    nlohmann::json
+    getSuiteReportJson(const std::vector<PairResult>& results, Clock::duration time) const;
+    std::string
+    getSuiteReportText(const std::vector<PairResult>& results, Clock::duration time) const;
+    std::string getJUnitReport(const std::vector<PairResult>& results, Clock::duration time) const;
+
     // String from CLI to be parsed into a double
     std::string argThreshold;
+    // String from CLI to be parsed into a double
+    std::string argSampleTolerance;
+    // Strings from CLI to be parsed into doubles
+    std::vector<std::string> argBandTolerances;
+    // JSON string or file path from CLI to be parsed into pairs of files
+    std::string argManifest;
+    // String from CLI to be parsed into a File object
+    std::string argOutPath;
+    // String from CLI to be parsed into an OutputFormat
+    std::string argOutFormat;
 
     double rmsThreshold{ juce::Decibels::decibelsToGain(-50.0, -96.0) };
-    std::map<AudioFileRole, juce::String> inputFilePaths{
-        { AudioFileRole::test, {} },
-        { AudioFileRole::reference, {} },
-    };
+    // defaults to the RMS threshold
+    std::optional<double> sampleToleranceOpt;
+    bool align{ false };
+    juce::int64 maxOffset{ 16384 };
+    bool spectral{ false };
+    int fftSize{ 2048 };
+    // the frequencies at which the bands above the first one start
+    std::vector<double> bandFrequencies{ 100.0, 500.0, 2000.0, 8000.0 };
+    // one for every band, or a single one for all of them. Default to the RMS threshold
+    std::vector<double> bandTolerances;
+    std::vector<SpectralBand> spectralBands;
+    unsigned int numThreads{ std::max(std::thread::hardware_concurrency(), 1u) };
+    juce::File outputFilePath;
+    OutputFormat outputFormat{ OutputFormat::text };
+    // paths of files or directories
+    std::string testPath;
+    std::string referencePath;
 };
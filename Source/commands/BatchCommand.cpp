@@ -0,0 +1,327 @@
+#include "BatchCommand.h"
+
+#include "Errors.h"
+#include "Parsers.h"
+#include "PluginProcess.h"
+#include "ProcessCommand.h"
+#include "Utils.h"
+#include "Validators.h"
+#include "WorkStealingQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <print>
+#include <string>
+#include <thread>
+#include <vector>
+
+static double toSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+std::shared_ptr<CLI::App> BatchCommand::createApp() {
+    std::shared_ptr<CLI::App> app = std::make_shared<CLI::App>(
+        "Processes a list of jobs using a single instance of a plugin", "batch"
+    );
+
+    // don't break these lines, please
+    // clang-format off
+    app->add_option("-p,--plugin", argPluginPath, "Plugin path")->required()
+        ->check(CLI::ExistingPath) // not ExistingFile because on macOS, these bundles are directores
+        ->each([&](std::string arg){ pluginPath = parse::stringToFile(arg); });
+    app->add_option("--preset", presetFileOpt, "Preset file path, applied once after loading the plugin. Currently only .vstpreset files for VST3 are supported.")
+        ->check(CLI::ExistingFile);
+    app->add_option("-j,--jobs", argJobs, "JSON string or file with an array of jobs. Each job is an object mapping long names of process options to their values.")
+        ->required();
+    app->add_option("-o,--output", argOutPath, "Output file path for the batch report. Will output to stdout if not supplied.")
+        ->check(validate::outputPath)
+        ->each([&](std::string arg) { outputFilePath = parse::stringToFile(arg); });
+    app->add_option("-f,--format", argOutFormat, "The report format (text, json)")
+        ->check(validate::textOrJson)
+        ->each([&](std::string arg) { outputFormat = parse::outputFormat(arg); });
+    app->add_flag("-y,--overwrite", overwriteOutputFile, "Overwrite the report and the jobs' output files if they exist");
+    app->add_option("-w,--workers", numWorkers, "The amount of threads processing jobs in parallel, each using its own instance of the plugin")
+        ->check(CLI::PositiveNumber);
+
+    // clang-format on
+    return app;
+}
+
+void BatchCommand::execute() {
+    const auto jobs = parseJobs();
+    const auto loadStart = Clock::now();
+
+    // the plugin is only scanned once, and every worker creates its own instance from that.
+    // the sample rate and block size are only placeholders,
+    // since every job prepares the plugin with its own.
+    const double dummySampleRate{ 48000.0 };
+    const int dummyBlockSize{ 1024 };
+    const auto pluginDescription =
+        PluginUtils::findPluginDescription(pluginPath.getFullPathName());
+
+    // instances are created here rather than on the worker threads,
+    // since plugins generally expect to be created on the message thread
+    workers.resize(std::min(numWorkers, std::max<std::size_t>(jobs.size(), 1)));
+    for (auto& worker : workers) {
+        worker.plugin = PluginUtils::createPluginInstance(
+            pluginDescription, dummySampleRate, dummyBlockSize
+        );
+
+        if (presetFileOpt) {
+            applyPresetFile(*worker.plugin, *presetFileOpt);
+        }
+
+        worker.plugin->getStateInformation(worker.initialState);
+    }
+
+    loadTime = Clock::now() - loadStart;
+    const auto processStart = Clock::now();
+
+    // deal the jobs out round-robin, workers that finish early steal the rest
+    WorkStealingQueue<std::size_t> queue{ workers.size() };
+    for (std::size_t i = 0; i < jobs.size(); i++) {
+        queue.push(i % workers.size(), i);
+    }
+
+    // every job writes to its own result, so workers don't need to synchronize
+    results.resize(jobs.size());
+    auto work = [&](std::size_t workerIndex) {
+        while (const auto jobIndex = queue.pop(workerIndex)) {
+            results[*jobIndex] = runJob(workerIndex, *jobIndex, jobs[*jobIndex]);
+        }
+    };
+
+    if (workers.size() == 1) {
+        // a single worker processes everything on the thread the plugin was created on
+        work(0);
+    } else {
+        // the workers only render audio, and hand the plugin's other calls back to this thread,
+        // which serves them until the last worker is done
+        std::atomic<std::size_t> numWorking{ workers.size() };
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            threads.emplace_back([&, i] {
+                work(i);
+                if (--numWorking == 0) {
+                    hostThread.finish();
+                }
+            });
+        }
+        hostThread.serve();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    processTime = Clock::now() - processStart;
+
+    if (outputFormat == OutputFormat::json) {
+        outputResult(getReportJson().dump(4), outputFilePath, overwriteOutputFile);
+    } else {
+        outputResult(getReportText(), outputFilePath, overwriteOutputFile);
+    }
+
+    const auto numFailed = std::ranges::count_if(results, [](const JobResult& result) {
+        return !result.error.empty();
+    });
+    if (numFailed > 0) {
+        throw CLIException(std::format("{} of {} jobs failed", numFailed, results.size()));
+    }
+}
+
+BatchCommand::JobResult
+BatchCommand::runJob(std::size_t workerIndex, std::size_t jobIndex, const nlohmann::json& job) {
+    auto& worker = workers[workerIndex];
+    const auto jobStart = Clock::now();
+
+    JobResult result;
+    result.worker = workerIndex;
+    if (job.contains("output") && job["output"].is_string()) {
+        result.outputPath = job["output"].get<std::string>();
+    }
+
+    try {
+        if (worker.numJobs > 0) {
+            callPlugin([&] {
+                worker.plugin->setStateInformation(
+                    worker.initialState.getData(), static_cast<int>(worker.initialState.getSize())
+                );
+            });
+        }
+
+        // CLI11 expects the arguments reversed
+        auto arguments = getProcessArguments(job);
+        std::ranges::reverse(arguments);
+
+        ProcessCommand processCommand;
+        processCommand.createApp()->parse(arguments);
+        if (workers.size() > 1) {
+            processCommand.setHostThread(hostThread);
+        }
+        result.numSamples = processCommand.process(*worker.plugin);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+        std::println(stderr, "Job {} failed: {}", jobIndex + 1, result.error);
+    }
+
+    // the next job negotiates its own buses layout and prepares the plugin again,
+    // which also clears anything left over from this job's processing
+    try {
+        callPlugin([&] { worker.plugin->releaseResources(); });
+    } catch (const std::exception& e) {
+        std::println(stderr, "Job {} couldn't release the plugin: {}", jobIndex + 1, e.what());
+    }
+
+    result.time = Clock::now() - jobStart;
+    worker.numJobs++;
+    worker.busyTime += result.time;
+    return result;
+}
+
+void BatchCommand::callPlugin(const std::function<void()>& function) {
+    if (workers.size() > 1) {
+        hostThread.call(function);
+    } else {
+        function();
+    }
+}
+
+std::vector<nlohmann::json> BatchCommand::parseJobs() const {
+    nlohmann::json jobsJson;
+    try {
+        jobsJson = getJson(argJobs);
+    } catch (const nlohmann::json::exception& e) {
+        throw ParseError{ std::format("Couldn't parse job list: {}", e.what()), 171 };
+    }
+
+    if (!jobsJson.is_array()) {
+        throw ParseError{ "The job list must be a JSON array", 171 };
+    }
+
+    std::vector<nlohmann::json> jobs;
+    for (const auto& job : jobsJson) {
+        if (!job.is_object()) {
+            throw ParseError{ std::format("Job {} is not a JSON object", jobs.size() + 1), 171 };
+        }
+        for (const auto& key : { "plugin", "preset" }) {
+            if (job.contains(key)) {
+                throw ParseError{
+                    std::format(
+                        "Job {} sets '{}', which is shared by all jobs and must be supplied to "
+                        "the batch command instead",
+                        jobs.size() + 1, key
+                    ),
+                    171
+                };
+            }
+        }
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+std::vector<std::string> BatchCommand::getProcessArguments(const nlohmann::json& job) const {
+    // the plugin is required by the process command,
+    // even though the job uses the already loaded instance
+    std::vector<std::string> arguments{ "--plugin", pluginPath.getFullPathName().toStdString() };
+    std::ranges::copy(parse::optionsToArguments(job), std::back_inserter(arguments));
+
+    if (overwriteOutputFile && !job.contains("overwrite")) {
+        arguments.push_back("--overwrite");
+    }
+
+    return arguments;
+}
+
+nlohmann::json BatchCommand::getReportJson() const {
+    const auto processSeconds = toSeconds(processTime);
+
+    nlohmann::json jobsJson = nlohmann::json::array();
+    std::size_t numFailed = 0;
+    std::size_t totalNumSamples = 0;
+
+    for (const auto& result : results) {
+        nlohmann::json jobJson{
+            { "output", result.outputPath },
+            { "worker", result.worker },
+            { "seconds", toSeconds(result.time) },
+            { "samples", result.numSamples },
+        };
+        if (!result.error.empty()) {
+            jobJson["error"] = result.error;
+            numFailed++;
+        }
+        totalNumSamples += result.numSamples;
+        jobsJson.push_back(jobJson);
+    }
+
+    nlohmann::json workersJson = nlohmann::json::array();
+    for (const auto& worker : workers) {
+        const auto busySeconds = toSeconds(worker.busyTime);
+        workersJson.push_back({
+            { "jobs", worker.numJobs },
+            { "busySeconds", busySeconds },
+            // share of the processing time the worker spent on jobs
+            { "utilization", processSeconds > 0.0 ? busySeconds / processSeconds : 0.0 },
+        });
+    }
+
+    return {
+        { "pluginLoadSeconds", toSeconds(loadTime) },
+        { "processSeconds", processSeconds },
+        { "totalSeconds", toSeconds(loadTime + processTime) },
+        { "succeeded", results.size() - numFailed },
+        { "failed", numFailed },
+        { "samples", totalNumSamples },
+        { "samplesPerSecond",
+          processSeconds > 0.0 ? static_cast<double>(totalNumSamples) / processSeconds : 0.0 },
+        { "jobsPerSecond",
+          processSeconds > 0.0 ? static_cast<double>(results.size()) / processSeconds : 0.0 },
+        { "workers", workersJson },
+        { "jobs", jobsJson },
+    };
+}
+
+std::string BatchCommand::getReportText() const {
+    const auto json = getReportJson();
+
+    std::string text = std::format(
+        "Loaded {} plugin instance{} in {:.3f} s\n", workers.size(),
+        workers.size() == 1 ? "" : "s", json["pluginLoadSeconds"].get<double>()
+    );
+
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        if (result.error.empty()) {
+            text += std::format(
+                "Job {}: {} ({} samples) in {:.3f} s\n", i + 1, result.outputPath,
+                result.numSamples, toSeconds(result.time)
+            );
+        } else {
+            text += std::format("Job {}: failed: {}\n", i + 1, result.error);
+        }
+    }
+
+    if (workers.size() > 1) {
+        for (std::size_t i = 0; i < workers.size(); i++) {
+            const auto& workerJson = json["workers"][i];
+            text += std::format(
+                "Worker {}: {} jobs, busy for {:.3f} s ({:.1f}% utilization)\n", i + 1,
+                workerJson["jobs"].get<std::size_t>(), workerJson["busySeconds"].get<double>(),
+                workerJson["utilization"].get<double>() * 100.0
+            );
+        }
+    }
+
+    text += std::format(
+        "Processed {} of {} jobs in {:.3f} s ({:.2f} jobs/s, {:.0f} samples/s)\n",
+        json["succeeded"].get<std::size_t>(), results.size(), json["processSeconds"].get<double>(),
+        json["jobsPerSecond"].get<double>(), json["samplesPerSecond"].get<double>()
+    );
+    return text;
+}
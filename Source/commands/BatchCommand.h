@@ -0,0 +1,90 @@
+#pragma once
+
+#include "CLICommand.h"
+#include "HostThread.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Processes a list of jobs using a single instance of a plugin per worker thread,
+ * so the plugin only has to be loaded once per worker.
+ *
+ * Each job is a JSON object mapping long names of process command options to their values,
+ * and is executed like a process command using the worker's plugin instance.
+ * With more than one worker, the worker threads only render audio. Every other call to a plugin,
+ * like restoring its state or preparing it, is handed back to the thread that created it.
+ */
+class BatchCommand : public CLICommand {
+  public:
+    std::shared_ptr<CLI::App> createApp() override;
+
+    void execute() override;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct JobResult {
+        std::string outputPath;
+        // index of the worker that processed the job
+        std::size_t worker{ 0 };
+        // length of the job's output, zero if it failed
+        std::size_t numSamples{ 0 };
+        Clock::duration time{ 0 };
+        // empty if the job succeeded
+        std::string error;
+    };
+
+    /* A thread processing jobs with its own plugin instance */
+    struct Worker {
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        // the plugin's state right after loading, which every job starts from
+        juce::MemoryBlock initialState;
+        std::size_t numJobs{ 0 };
+        // time spent processing jobs, as opposed to waiting for other workers to finish
+        Clock::duration busyTime{ 0 };
+    };
+
+    // Parses the job list, throwing a ParseError if it's malformed
+    std::vector<nlohmann::json> parseJobs() const;
+    // Converts a job into the command line arguments of a process command
+    std::vector<std::string> getProcessArguments(const nlohmann::json& job) const;
+    JobResult runJob(std::size_t workerIndex, std::size_t jobIndex, const nlohmann::json& job);
+    // Calls a plugin outside of rendering, on the thread the plugins were created on
+    void callPlugin(const std::function<void()>& function);
+    nlohmann::json getReportJson() const;
+    std::string getReportText() const;
+
+    // String from CLI to be parsed into a File object
+    std::string argPluginPath;
+    // JSON string or file path from CLI to be parsed into jobs
+    std::string argJobs;
+    // String from CLI to be parsed into a File object
+    std::string argOutPath;
+    // String from CLI to be parsed into an OutputFormat
+    std::string argOutFormat;
+
+    juce::File pluginPath;
+    std::optional<juce::File> presetFileOpt;
+    juce::File outputFilePath;
+    OutputFormat outputFormat{ OutputFormat::text };
+    bool overwriteOutputFile{ false };
+    std::size_t numWorkers{ 1 };
+
+    std::vector<Worker> workers;
+    // the thread the plugins were created on, serving their non-audio calls while workers run
+    HostThread hostThread;
+    std::vector<JobResult> results;
+    // time spent loading the plugin instances
+    Clock::duration loadTime{ 0 };
+    // time spent processing all jobs, after loading the plugin instances
+    Clock::duration processTime{ 0 };
+};
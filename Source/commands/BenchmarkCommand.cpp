@@ -0,0 +1,264 @@
+#include "BenchmarkCommand.h"
+
+#include "Automation.h"
+#include "Errors.h"
+#include "Parsers.h"
+#include "PluginProcess.h"
+#include "Validators.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <print>
+
+/**
+ * @param values The values. Must not be empty.
+ * @return The median of the values.
+ */
+static double getMedian(std::vector<double> values) {
+    std::ranges::sort(values);
+    const auto middle = values.size() / 2;
+    if (values.size() % 2 == 0) {
+        return (values[middle - 1] + values[middle]) / 2.0;
+    }
+    return values[middle];
+}
+
+std::shared_ptr<CLI::App> BenchmarkCommand::createApp() {
+    std::shared_ptr<CLI::App> app = std::make_shared<CLI::App>(
+        "Measures how long a plugin takes to process at different block sizes and sample rates",
+        "benchmark"
+    );
+
+    // don't break these lines, please
+    // clang-format off
+    app->add_option("-p,--plugin", argPluginPath, "Plugin path")
+        ->required()
+        ->check(CLI::ExistingPath)
+        ->each([&](std::string arg){ pluginPath = parse::stringToFile(arg); });
+    app->add_option("-g,--generatorInput", argGenerator, "JSON string or file with the configuration to generate audio input. Can be supplied multiple times for multiple input buses. Without one, the plugin processes silence")
+        ->check(validate::generator)
+        ->each([&](std::string arg){ generators.push_back(parse::generatorInput(arg)); });
+    app->add_option("--preset", presetFileOpt, "Preset file path. Currently only .vstpreset files for VST3 are supported.")
+        ->check(CLI::ExistingFile);
+    app->add_option("--blockSizes", blockSizes, "Comma-separated block sizes to measure. Defaults to the powers of two from 32 to 8192")
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+    app->add_option("--sampleRates", sampleRates, "Comma-separated sample rates to measure. Defaults to 44100, 48000 and 96000")
+        ->delimiter(',')
+        ->check(CLI::PositiveNumber);
+    app->add_option("--warmup", argWarmup, "How much audio to process before measuring, after preparing the plugin for each block size and sample rate, in seconds or with an s or ms suffix. Defaults to 500ms")
+        ->check(validate::duration)
+        ->each([&](std::string arg) { warmupSeconds = parse::duration(arg); });
+    app->add_option("--duration", argDuration, "How much audio to process in each repetition of a measurement, in seconds or with an s or ms suffix. Defaults to 2s")
+        ->check(validate::duration)
+        ->each([&](std::string arg) { durationSeconds = parse::duration(arg); });
+    app->add_option("--repetitions", numRepetitions, "How many times to repeat each measurement. The median is reported. Defaults to 5")
+        ->check(CLI::PositiveNumber);
+    app->add_option("--paramFile", argParamsFile, "Path to JSON file to read plugin parameters from. Automation is not applied, the parameters keep their initial values")
+        ->check(CLI::ExistingFile)
+        ->each([&](std::string arg){ paramsFileOpt = parse::stringToFile(arg); });
+    app->add_option("--param", params, "Plugin parameters to set. Explicitly specified parameters take precedence over parameters read from file")
+        ->check(validate::pluginParameter);
+    app->add_option("-o,--output", argOutPath, "Output file path for the results. Will output to stdout if not supplied.")
+        ->check(validate::outputPath)
+        ->each([&](std::string arg) { outputFilePath = parse::stringToFile(arg); });
+    app->add_option("-f,--format", argOutFormat, "The output format (text, json)")
+        ->check(validate::outputFormat)
+        ->each([&](std::string arg) { outputFormat = parse::outputFormat(arg); });
+    app->add_flag("-y,--overwrite", overwriteOutputFile, "Overwrite the output file if it exists");
+
+    // clang-format on
+    return app;
+}
+
+void BenchmarkCommand::execute() {
+    const auto plugin = PluginUtils::createPluginInstance(
+        pluginPath.getFullPathName(), sampleRates.front(), *std::ranges::max_element(blockSizes)
+    );
+
+    if (presetFileOpt) {
+        applyPresetFile(*plugin, *presetFileOpt);
+    }
+
+    executeWithPlugin(*plugin);
+}
+
+void BenchmarkCommand::executeWithPlugin(juce::AudioPluginInstance& plugin) {
+    setBusesLayout(plugin);
+
+    // only the initial values of the parameters are applied, since the measurements don't
+    // correspond to a position in time
+    const auto numSamplesPerCell = static_cast<size_t>(std::ceil(
+        (warmupSeconds + durationSeconds * numRepetitions) * sampleRates.front()
+    ));
+    auto automation =
+        parseParameters(plugin, sampleRates.front(), numSamplesPerCell, paramsFileOpt, params);
+    Automation::applyParameters(automation, 0);
+
+    std::vector<Measurement> measurements;
+    for (const auto sampleRate : sampleRates) {
+        for (const auto blockSize : blockSizes) {
+            measurements.push_back(measure(plugin, sampleRate, blockSize));
+        }
+    }
+
+    if (outputFormat == OutputFormat::text) {
+        outputResult(toString(plugin, measurements), outputFilePath, overwriteOutputFile);
+    } else if (outputFormat == OutputFormat::json) {
+        outputResult(toJson(plugin, measurements).dump(4), outputFilePath, overwriteOutputFile);
+    }
+}
+
+void BenchmarkCommand::setBusesLayout(juce::AudioPluginInstance& plugin) const {
+    if (!PluginUtils::pluginSupportsSingleOutputBus(plugin)) {
+        throw PluginError{
+            "The plugin does not support a single output bus and Plugalyzer does not "
+            "support multiple outputs.",
+            62
+        };
+    }
+
+    juce::AudioProcessor::BusesLayout layout{
+        .inputBuses = {},
+        .outputBuses = juce::Array{ plugin.getBusesLayout().getMainOutputChannelSet() },
+    };
+    for (const auto& generator : generators) {
+        layout.inputBuses.add(generator.getChannelLayout());
+    }
+
+    if (!generators.empty() && !plugin.setBusesLayout(layout)) {
+        std::println(
+            stderr,
+            "The generators produce the following layout:\n{}\n"
+            "But the plugin does not support it. Using the plugin's default layout instead.",
+            describeBusesLayout(layout).toStdString()
+        );
+    }
+}
+
+BenchmarkCommand::Measurement
+BenchmarkCommand::measure(juce::AudioPluginInstance& plugin, double sampleRate, int blockSize) {
+    using Clock = std::chrono::steady_clock;
+
+    plugin.prepareToPlay(sampleRate, blockSize);
+    for (auto& generator : generators) {
+        generator.prepare(sampleRate, static_cast<juce::uint32>(blockSize));
+    }
+
+    const auto layout = plugin.getBusesLayout();
+    const auto numInputChannels = getTotalNumInputChannels(layout);
+    const auto numChannels = std::max(numInputChannels, getTotalNumOutputChannels(layout));
+    juce::AudioBuffer<float> buffer{ numChannels, blockSize };
+    juce::MidiBuffer midiBuffer;
+
+    // generates the next block of input and returns how long the plugin took to process it
+    auto processBlock = [&] {
+        buffer.clear();
+        int channel = 0;
+        for (auto& generator : generators) {
+            const auto numGeneratorChannels = generator.getChannelLayout().size();
+            // generators whose bus the plugin doesn't have are left out
+            if (channel + numGeneratorChannels > numInputChannels) {
+                break;
+            }
+            auto block = juce::dsp::AudioBlock<float>{ buffer }.getSubsetChannelBlock(
+                static_cast<size_t>(channel), static_cast<size_t>(numGeneratorChannels)
+            );
+            generator.processChannels(block);
+            channel += numGeneratorChannels;
+        }
+
+        const auto start = Clock::now();
+        plugin.processBlock(buffer, midiBuffer);
+        return Clock::now() - start;
+    };
+
+    auto getNumBlocks = [&](double seconds) {
+        return static_cast<int>(std::ceil(seconds * sampleRate / blockSize));
+    };
+
+    for (int i = 0; i < getNumBlocks(warmupSeconds); i++) {
+        processBlock();
+    }
+
+    const auto numBlocksPerRepetition = std::max(getNumBlocks(durationSeconds), 1);
+    const auto numSamplesPerRepetition = static_cast<double>(numBlocksPerRepetition) * blockSize;
+    std::vector<double> nanosecondsPerSample;
+    Clock::duration worstBlockTime{ 0 };
+    for (int repetition = 0; repetition < numRepetitions; repetition++) {
+        Clock::duration repetitionTime{ 0 };
+        for (int i = 0; i < numBlocksPerRepetition; i++) {
+            const auto blockTime = processBlock();
+            repetitionTime += blockTime;
+            worstBlockTime = std::max(worstBlockTime, blockTime);
+        }
+        nanosecondsPerSample.push_back(
+            std::chrono::duration<double, std::nano>(repetitionTime).count() /
+            numSamplesPerRepetition
+        );
+    }
+
+    plugin.releaseResources();
+
+    const auto medianNanosecondsPerSample = getMedian(nanosecondsPerSample);
+    const auto nanosecondsPerBlock = 1e9 * blockSize / sampleRate;
+    return {
+        .sampleRate = sampleRate,
+        .blockSize = blockSize,
+        .nanosecondsPerSample = medianNanosecondsPerSample,
+        .minNanosecondsPerSample = *std::ranges::min_element(nanosecondsPerSample),
+        .realTimeFactor = medianNanosecondsPerSample > 0.0
+                              ? 1e9 / (sampleRate * medianNanosecondsPerSample)
+                              : 0.0,
+        .worstBlockLoad =
+            std::chrono::duration<double, std::nano>(worstBlockTime).count() / nanosecondsPerBlock,
+    };
+}
+
+nlohmann::json BenchmarkCommand::toJson(
+    const juce::AudioPluginInstance& plugin, const std::vector<Measurement>& measurements
+) const {
+    nlohmann::json json{
+        { "plugin", plugin.getName().toStdString() },
+        { "warmupSeconds", warmupSeconds },
+        { "durationSeconds", durationSeconds },
+        { "repetitions", numRepetitions },
+        { "results", nlohmann::json::array() },
+    };
+
+    for (const auto& measurement : measurements) {
+        json["results"].push_back({
+            { "sampleRate", measurement.sampleRate },
+            { "blockSize", measurement.blockSize },
+            { "nanosecondsPerSample", measurement.nanosecondsPerSample },
+            { "minNanosecondsPerSample", measurement.minNanosecondsPerSample },
+            { "realTimeFactor", measurement.realTimeFactor },
+            { "worstBlockLoad", measurement.worstBlockLoad },
+        });
+    }
+
+    return json;
+}
+
+std::string BenchmarkCommand::toString(
+    const juce::AudioPluginInstance& plugin, const std::vector<Measurement>& measurements
+) const {
+    std::string text = std::format(
+        "Benchmark of {}: {} repetitions of {:.3f} s after {:.3f} s of warmup\n\n",
+        plugin.getName().toStdString(), numRepetitions, durationSeconds, warmupSeconds
+    );
+    text += std::format(
+        "{:>11}  {:>10}  {:>10}  {:>14}  {:>16}\n", "Sample rate", "Block size", "ns/sample",
+        "Real time", "Worst block load"
+    );
+    for (const auto& measurement : measurements) {
+        text += std::format(
+            "{:>11}  {:>10}  {:>10.2f}  {:>13.2f}x  {:>15.1f}%\n", measurement.sampleRate,
+            measurement.blockSize, measurement.nanosecondsPerSample, measurement.realTimeFactor,
+            measurement.worstBlockLoad * 100.0
+        );
+    }
+    return text;
+}
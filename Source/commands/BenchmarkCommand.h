@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Generators.h"
+#include "PluginCommand.h"
+#include "Utils.h"
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+class BenchmarkCommand : public PluginCommand {
+  public:
+    std::shared_ptr<CLI::App> createApp() override;
+
+    void execute() override;
+    void executeWithPlugin(juce::AudioPluginInstance& plugin) override;
+
+  private:
+    /* The cost of processing at a single block size and sample rate */
+    struct Measurement {
+        double sampleRate{ 0.0 };
+        int blockSize{ 0 };
+        // median across the repetitions
+        double nanosecondsPerSample{ 0.0 };
+        // fastest repetition
+        double minNanosecondsPerSample{ 0.0 };
+        // how many times faster than real time the plugin processes, based on the median
+        double realTimeFactor{ 0.0 };
+        // the slowest processBlock call relative to the duration of a block.
+        // above 1, a live host would have dropped out.
+        double worstBlockLoad{ 0.0 };
+    };
+
+    // Feeds the generators into the plugin's inputs, if the plugin supports their layout
+    void setBusesLayout(juce::AudioPluginInstance& plugin) const;
+    // Prepares the plugin for the given settings and measures how long it takes to process
+    Measurement measure(juce::AudioPluginInstance& plugin, double sampleRate, int blockSize);
+    nlohmann::json toJson(
+        const juce::AudioPluginInstance& plugin, const std::vector<Measurement>& measurements
+    ) const;
+    std::string toString(
+        const juce::AudioPluginInstance& plugin, const std::vector<Measurement>& measurements
+    ) const;
+
+    // String from CLI to be parsed into a File object
+    std::string argPluginPath;
+    // String from CLI to be parsed into a Generator
+    std::string argGenerator;
+    // String from CLI to be parsed into a duration
+    std::string argWarmup;
+    // String from CLI to be parsed into a duration
+    std::string argDuration;
+    // String from CLI to be parsed into a File object
+    std::string argParamsFile;
+    // String from CLI to be parsed into a File object
+    std::string argOutPath;
+    // String from CLI to be parsed into an OutputFormat
+    std::string argOutFormat;
+
+    juce::File pluginPath;
+    std::optional<juce::File> presetFileOpt;
+    std::vector<GeneratorInputBus> generators;
+    std::vector<int> blockSizes{ 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    std::vector<double> sampleRates{ 44100.0, 48000.0, 96000.0 };
+    double warmupSeconds{ 0.5 };
+    double durationSeconds{ 2.0 };
+    int numRepetitions{ 5 };
+    std::optional<juce::File> paramsFileOpt;
+    std::vector<std::string> params;
+    juce::File outputFilePath;
+    OutputFormat outputFormat{ OutputFormat::text };
+    bool overwriteOutputFile{ false };
+};
@@ -93,7 +93,11 @@ void BusLayoutsCommand::execute() {
     const auto plugin = PluginUtils::createPluginInstance(
         pluginPath.getFullPathName(), dummySampleRate, dummyBlockSize
     );
-    const auto busLayoutsJson = checkPossibleBusLayouts(*plugin);
+    executeWithPlugin(*plugin);
+}
+
+void BusLayoutsCommand::executeWithPlugin(juce::AudioPluginInstance& plugin) {
+    const auto busLayoutsJson = checkPossibleBusLayouts(plugin);
 
     if (outputFormat == OutputFormat::text) {
         const auto busLayoutsText = getBusLayoutHumanReadable(busLayoutsJson);
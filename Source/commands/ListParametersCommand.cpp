@@ -138,7 +138,11 @@ void ListParametersCommand::execute() {
     const auto plugin = PluginUtils::createPluginInstance(
         pluginPath.getFullPathName(), dummySampleRate, dummyBlockSize
     );
-    auto params = plugin->getParameters();
+    executeWithPlugin(*plugin);
+}
+
+void ListParametersCommand::executeWithPlugin(juce::AudioPluginInstance& plugin) {
+    auto params = plugin.getParameters();
     auto paramJson = getParametersAsJson(params);
 
     if (outputFormat == OutputFormat::text) {
@@ -1,16 +1,17 @@
 #pragma once
 
-#include "CLICommand.h"
+#include "PluginCommand.h"
 #include "Utils.h"
 
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <nlohmann/json.hpp>
 
-class ListParametersCommand : public CLICommand {
+class ListParametersCommand : public PluginCommand {
   public:
     std::shared_ptr<CLI::App> createApp() override;
 
     void execute() override;
+    void executeWithPlugin(juce::AudioPluginInstance& plugin) override;
 
   private:
     // String from CLI to be parsed into a File object
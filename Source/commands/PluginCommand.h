@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CLICommand.h"
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+/**
+ * A command operating on a single plugin instance.
+ * The instance can also be supplied by the caller, so a loaded plugin can be reused
+ * across multiple executions.
+ */
+class PluginCommand : public CLICommand {
+  public:
+    /**
+     * Executes this command using an already loaded plugin instance
+     * instead of loading the plugin given on the command line.
+     * The preset, if any, is not applied.
+     *
+     * @param plugin The plugin instance. Must not be prepared for playback.
+     */
+    virtual void executeWithPlugin(juce::AudioPluginInstance& plugin) = 0;
+};
@@ -1,21 +1,38 @@
 #include "ProcessCommand.h"
 
+#include "AudioStreams.h"
+#include "BlockPipeline.h"
+#include "BufferedFileOutputStream.h"
 #include "Errors.h"
 #include "Generators.h"
+#include "MidiSchedule.h"
 #include "Parsers.h"
 #include "PluginProcess.h"
-#include "PresetLoadingExtensionsVisitor.h"
+#include "RealtimeAudit.h"
+#include "RenderStats.h"
+#include "Resampler.h"
+#include "TailDetector.h"
 #include "Utils.h"
 #include "Validators.h"
+#include "Wave64Writer.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
+#include <exception>
 #include <format>
+#include <functional>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <print>
+#include <stop_token>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <variant>
 #include <vector>
 
@@ -29,8 +46,8 @@ std::shared_ptr<CLI::App> ProcessCommand::createApp() {
         ->each([&](std::string arg){ pluginPath = parse::stringToFile(arg); });
 
     auto* inputGroup = app->add_option_group("input");
-    auto* audioInputOption = inputGroup->add_option("-i,--input", argInputSources, "Input audio file path")
-        ->check(CLI::ExistingFile)
+    auto* audioInputOption = inputGroup->add_option("-i,--input", argInputSources, "Input audio file path, or - to read from stdin")
+        ->check(validate::existingFileOrStdin)
         ->check([&](const std::string& arg) { return this->validateInputFileSampleRate(arg); })
         ->each([&](std::string arg){ audioInputs.push_back(parseAudioFileInput(arg)); });
     inputGroup->add_option("-m,--midiInput", midiInputFileOpt, "Input MIDI file path")
@@ -45,18 +62,86 @@ std::shared_ptr<CLI::App> ProcessCommand::createApp() {
     app->add_option("--preset", presetFileOpt, "Preset file path. Currently only .vstpreset files for VST3 are supported.")
         ->check(CLI::ExistingFile);
 
-    app->add_option("-o,--output", argOutPath, "Output audio file path")
+    app->add_option("-o,--output", argOutPath, "Output audio file path, or - to write to stdout")
         ->required()
         ->check(validate::outputPath)
-        ->each([&](std::string arg) { outputFilePath = parse::stringToFile(arg); });
+        ->each([&](std::string arg) {
+            writeToStdout = arg == standardStreamPath;
+            outputFilePath = parse::stringToFile(arg);
+        });
+    app->add_option("--outputFormat", argOutFormat, "The output file's format: wav, w64, raw (32 bit float samples without a header) or flac. Defaults to the format matching the output file's extension, or wav")
+        ->check(validate::audioFileFormat)
+        ->each([&](std::string arg) { outputFileFormatOpt = parse::audioFileFormat(arg); });
     app->add_flag("-y,--overwrite", overwriteOutputFile, "Overwrite the output file if it exists");
+    app->add_option("--writeBufferSize", writeBufferSize, "The size of the buffer used for writing the output file, in bytes")
+        ->check(CLI::PositiveNumber);
+    app->add_flag("--verbose", verbose, "Print diagnostic information, such as output file I/O statistics, to stderr");
+    auto* statsOption = app->add_option("--stats", argStatsFormat, "Measure the time spent in each processing stage and output the statistics in the given format (text, json)")
+        ->check(validate::textOrJson)
+        ->each([&](std::string arg) { statsFormatOpt = parse::outputFormat(arg); });
+    auto* auditRealtimeOption = app->add_flag("--auditRealtime", auditRealtime, "Count the memory allocations and mutex locks the plugin performs inside processBlock and report them to stderr, along with the worst blocks. Only available on Linux");
+    app->add_flag("--failOnRealtimeViolations", failOnRealtimeViolations, "Exit with an error if the real-time safety audit found any violations")
+        ->needs(auditRealtimeOption);
+    app->add_option("--statsOutput", argStatsPath, "Output file path for the statistics. Will output to stdout if not supplied.")
+        ->needs(statsOption)
+        ->check(validate::outputPath)
+        ->each([&](std::string arg) { statsFilePath = parse::stringToFile(arg); });
+
+    // options of the main app are processed before the input group,
+    // so these are set by the time stdin is opened
+    auto* stdinFormatOption = app->add_option("--stdinFormat", argStdinFormat, "Format of the audio read from stdin: wav (default), or raw PCM as s16le, s24le, s32le or f32le")
+        ->check(validate::streamFormat)
+        ->each([&](std::string arg) { stdinFormat = parse::streamFormat(arg); });
+    app->add_option("--stdinChannels", stdinChannelsOpt, "The amount of channels of raw PCM read from stdin")
+        ->needs(stdinFormatOption)
+        ->check(CLI::PositiveNumber);
+    app->add_option("--stdinSampleRate", stdinSampleRateOpt, "The sample rate of raw PCM read from stdin")
+        ->needs(stdinFormatOption)
+        ->check(CLI::PositiveNumber);
+    app->add_option("--resampleQuality", argResampleQuality, "The quality of converting inputs with other sample rates and the output: fast, good or best (default)")
+        ->check(validate::resamplingQuality)
+        ->each([&](std::string arg) { resamplingQuality = parse::resamplingQuality(arg); });
+    app->add_option("--stdoutFormat", argStdoutFormat, "Format of the audio written to stdout: wav (default), or raw PCM as s16le, s24le, s32le or f32le")
+        ->check(validate::streamFormat)
+        ->each([&](std::string arg) { stdoutFormat = parse::streamFormat(arg); });
 
     auto* sampleRateOption = app->add_option("-s,--sampleRate", argSampleRate, "The sample rate to use for processing when no audio input is supplied");
     // sample rate is dictated by input audio files/generators if they're provided
     audioInputOption->excludes(sampleRateOption);
     generatorInputOption->excludes(sampleRateOption);
 
+    app->add_option("--outputSampleRate", outputSampleRateOpt, "The sample rate of the output file, if it should differ from the sample rate used for processing")
+        ->check(CLI::PositiveNumber);
+
     app->add_option("-b,--blockSize", blockSize, "The buffer size to use when processing audio");
+    app->add_flag("--doublePrecision", useDoublePrecision, "Process in double precision if the plugin supports it");
+    app->add_flag("--pipeline", usePipeline, "Read input and write output on separate threads while the plugin is processing");
+    app->add_option("--pipelineDepth", pipelineDepth, "The amount of blocks buffered between the reading, processing and writing threads when using --pipeline")
+        ->check(CLI::PositiveNumber);
+    app->add_option("--start", argStart, "Only render the inputs from this time on, in seconds or with an s or ms suffix")
+        ->check(validate::duration)
+        ->each([&](std::string arg) { startSeconds = parse::duration(arg); });
+    app->add_option("--duration", argDuration, "Only render this much of the inputs, in seconds or with an s or ms suffix")
+        ->check(validate::duration)
+        ->each([&](std::string arg) { durationSecondsOpt = parse::duration(arg); });
+    app->add_option("--preRoll", argPreRoll, "How long to process the inputs before --start and discard the output, so the plugin's state can settle. Defaults to 0")
+        ->check(validate::duration)
+        ->each([&](std::string arg) { preRollSeconds = parse::duration(arg); });
+    auto* tailOption = app->add_flag("--tail", renderTail, "Keep rendering after the inputs have ended until the plugin's output stays quiet, rather than only making up for its latency. The quiet end of the tail isn't written");
+    app->add_option("--tailThreshold", argTailThreshold, "The amplitude at or below which the output counts as quiet, linear or in dB. Defaults to -80dB")
+        ->needs(tailOption)
+        ->check(validate::amplitude)
+        ->each([&](std::string arg) { tailThreshold = parse::amplitude(arg); });
+    app->add_option("--tailWindow", argTailWindow, "How long the output has to stay quiet for the tail to end, in seconds or with an s or ms suffix. Defaults to 1s")
+        ->needs(tailOption)
+        ->check(validate::duration)
+        ->each([&](std::string arg) { tailWindowSeconds = parse::duration(arg); });
+    app->add_option("--maxTail", argMaxTail, "The longest tail to render, in seconds or with an s or ms suffix. Defaults to the tail length reported by the plugin plus the window, or 30s if it doesn't report one")
+        ->needs(tailOption)
+        ->check(validate::duration)
+        ->each([&](std::string arg) { maxTailSecondsOpt = parse::duration(arg); });
+    app->add_option("--automationResolution", automationResolutionOpt, "Split processing blocks at every keyframe, and into parts of at most <n> samples in between, evaluating automation at the start of each part. 0 only splits blocks at keyframes")
+        ->check(CLI::NonNegativeNumber);
     app->add_option("-d,--bitDepth", outputBitDepthOpt, "The output file's bit depth. Defaults to the input file's bit depth if present, or 16 bits if no input file is provided.")
         ->check(validate::bitDepth);
     app->add_option("-c,--outChannels", outputChannelCountOpt, "The amount of channels to use for the plugin's output bus");
@@ -72,143 +157,605 @@ std::shared_ptr<CLI::App> ProcessCommand::createApp() {
 }
 
 void ProcessCommand::execute() {
-    const auto sampleRate = inputSampleRate != 0.0 ? inputSampleRate : argSampleRate;
+    // create the plugin instance
+    auto plugin = PluginUtils::createPluginInstance(
+        pluginPath.getFullPathName(), getSampleRate(), (int) blockSize
+    );
+
+    if (presetFileOpt) {
+        applyPresetFile(*plugin, *presetFileOpt);
+    }
+
+    process(*plugin);
+}
+
+void ProcessCommand::executeWithPlugin(juce::AudioPluginInstance& plugin) { process(plugin); }
+
+std::size_t ProcessCommand::process(juce::AudioPluginInstance& plugin) {
+    if (auditRealtime && !RealtimeAudit::isSupported()) {
+        throw CLIException("Auditing real-time safety isn't supported in this build");
+    }
+    if (writeToStdout && statsFormatOpt && statsFilePath == juce::File{}) {
+        throw CLIException(
+            "Statistics can't be written to stdout along with the audio. Use --statsOutput"
+        );
+    }
+    const bool writeRawOutput = writeToStdout ? stdoutFormat != StreamFormat::wav
+                                              : getOutputFileFormat() == AudioFileFormat::raw;
+    if (writeRawOutput && outputBitDepthOpt) {
+        throw CLIException("The bit depth of raw output is set by its format");
+    }
+
+    const auto sampleRate = getSampleRate();
+    auto toSamples = [&](double seconds) {
+        return static_cast<size_t>(std::round(seconds * sampleRate));
+    };
+    // streamed inputs whose length isn't known up front don't count towards this
     auto totalInputLength = getLengthOfLongestAudioInput(sampleRate);
     auto bitDepth = audioInputs.size() > 0 ? getBitDepthOfInput() : 16;
     if (outputBitDepthOpt) {
         bitDepth = *outputBitDepthOpt;
     }
+    if (writeRawOutput) {
+        // raw files always hold 32 bit floats
+        bitDepth =
+            writeToStdout ? static_cast<int>(getPcmEncoding(stdoutFormat).bitsPerSample) : 32;
+    }
 
-    // read MIDI input file
-    juce::MidiFile midiFile;
+    // read MIDI input file and merge its tracks into a sample-indexed schedule
+    MidiSchedule midiSchedule;
     if (midiInputFileOpt) {
         size_t midiLength;
-        midiFile = readMIDIFile(*midiInputFileOpt, sampleRate, midiLength);
+        const auto midiFile = readMIDIFile(*midiInputFileOpt, sampleRate, midiLength);
+        midiSchedule = MidiSchedule::fromMidiFile(midiFile, sampleRate);
         totalInputLength = std::max(totalInputLength, midiLength);
     }
 
-    // create the plugin instance
-    auto plugin = PluginUtils::createPluginInstance(
-        pluginPath.getFullPathName(), sampleRate, (int) blockSize
-    );
-
-    if (presetFileOpt) {
-        // read preset file into memory block
-        juce::MemoryBlock presetData;
-        const auto presetInputStream = presetFileOpt->createInputStream();
-        presetInputStream->readIntoMemoryBlock(presetData);
-        // TODO: how to handle errors?
-
-        // apply preset
-        PresetLoadingExtensionsVisitor presetLoader(presetData);
-        plugin->getExtensions(presetLoader);
+    // the part of the inputs to render, preceded by as much of the pre-roll as fits before it
+    RenderRange range;
+    range.start = toSamples(startSeconds);
+    range.preRollStart = range.start - std::min(range.start, toSamples(preRollSeconds));
+    if (durationSecondsOpt) {
+        range.end = range.start + toSamples(*durationSecondsOpt);
     }
+    if (range.start > 0 && range.start >= totalInputLength && stdinInput == nullptr) {
+        throw CLIException(std::format(
+            "The start of the range at {}s is past the end of the inputs at {}s", startSeconds,
+            static_cast<double>(totalInputLength) / sampleRate
+        ));
+    }
+
+    // everything but rendering the audio happens on the host thread, if there is one
+    auto callPlugin = [this](const std::function<void()>& function) {
+        if (hostThread != nullptr) {
+            hostThread->call(function);
+        } else {
+            function();
+        }
+    };
 
-    // create and apply the bus layout
-    negotiateBusesLayout(*plugin);
+    ResolvedAutomation automation;
+    callPlugin([&] {
+        // create and apply the bus layout
+        negotiateBusesLayout(plugin);
 
-    // parse plugin parameters
-    auto automation = parseParameters(*plugin, sampleRate, totalInputLength, paramsFileOpt, params);
+        // parse plugin parameters
+        automation = parseParameters(plugin, sampleRate, totalInputLength, paramsFileOpt, params);
+    });
 
-    prepareAudioInputs(sampleRate, blockSize);
-    plugin->prepareToPlay(sampleRate, blockSize);
+    // process in double precision if requested and supported by the plugin
+    auto processInDoublePrecision = useDoublePrecision;
+    if (useDoublePrecision && !plugin.supportsDoublePrecisionProcessing()) {
+        std::println(
+            stderr,
+            "The plugin does not support double precision processing. "
+            "Falling back to single precision."
+        );
+        processInDoublePrecision = false;
+    }
 
-    const auto latency = plugin->getLatencySamples();
+    prepareAudioInputs(sampleRate, blockSize, range.preRollStart);
+    callPlugin([&] {
+        plugin.setProcessingPrecision(
+            processInDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                     : juce::AudioProcessor::singlePrecision
+        );
+        plugin.prepareToPlay(sampleRate, blockSize);
+    });
 
     // open output stream
-    if (outputFilePath.exists() && !overwriteOutputFile) {
+    if (!writeToStdout && outputFilePath.exists() && !overwriteOutputFile) {
         throw CLIException("Output file already exists! Use --overwrite to overwrite the file");
     }
 
-    auto totalNumInputChannels = getTotalNumInputChannels(plugin->getBusesLayout());
-    auto totalNumOutputChannels = getTotalNumOutputChannels(plugin->getBusesLayout());
-    std::unique_ptr<juce::AudioFormatWriter> outWriter;
-    outputFilePath.deleteFile();
-    if (std::unique_ptr<juce::OutputStream> outputStream{
-            outputFilePath.createOutputStream(static_cast<size_t>(blockSize)) }) {
-        juce::WavAudioFormat outFormat;
-        outWriter = outFormat.createWriterFor(
-            outputStream, // stream is now managed by writer
-            juce::AudioFormatWriterOptions{}
-                .withSampleRate(sampleRate)
-                .withNumChannels(static_cast<int>(totalNumOutputChannels))
-                .withBitsPerSample(static_cast<int>(bitDepth))
+    auto totalNumOutputChannels = getTotalNumOutputChannels(plugin.getBusesLayout());
+
+    // leave some room for the file header when reserving disk space
+    const auto outputSampleRate = outputSampleRateOpt.value_or(sampleRate);
+    const auto rangeLength =
+        std::min(totalInputLength, range.end) - std::min(totalInputLength, range.start);
+    const auto expectedOutputLength = static_cast<juce::int64>(
+        std::ceil(static_cast<double>(rangeLength) * outputSampleRate / sampleRate)
+    );
+    const auto expectedOutputSize =
+        expectedOutputLength * totalNumOutputChannels * (bitDepth / 8) + 4096;
+    BufferedFileOutputStream::Statistics writeStatistics;
+    std::unique_ptr<juce::AudioFormatWriter> outWriter = createOutputWriter(
+        outputSampleRate, static_cast<int>(totalNumOutputChannels), bitDepth, expectedOutputSize,
+        writeStatistics
+    );
+    if (!juce::exactlyEqual(outputSampleRate, sampleRate)) {
+        outWriter = std::make_unique<ResamplingAudioFormatWriter>(
+            std::move(outWriter), sampleRate, resamplingQuality
         );
-    } else {
-        throw CLIException(
-            "Could not create output stream to write to file " + outputFilePath.getFullPathName()
+    }
+
+    // find the end of the plugin's tail if requested, which needs the plugin to be prepared
+    std::optional<TailDetector> tailDetectorOpt;
+    if (renderTail) {
+        tailDetectorOpt.emplace(
+            tailThreshold, toSamples(tailWindowSeconds), toSamples(getMaxTailSeconds(plugin))
         );
     }
+    auto* tailDetector = tailDetectorOpt ? &*tailDetectorOpt : nullptr;
+
+    // measure the render if requested
+    std::optional<RenderStats> statsOpt;
+    if (statsFormatOpt) {
+        statsOpt.emplace();
+    }
+    auto* stats = statsOpt ? &*statsOpt : nullptr;
+
+    std::optional<RealtimeAudit> auditOpt;
+    if (auditRealtime) {
+        auditOpt.emplace(sampleRate);
+    }
+    auto* audit = auditOpt ? &*auditOpt : nullptr;
 
     // process the input files with the plugin
-    juce::AudioBuffer<float> sampleBuffer(
-        (int) std::max(totalNumInputChannels, totalNumOutputChannels), (int) blockSize
-    );
+    size_t numSamplesRendered;
+    if (processInDoublePrecision) {
+        numSamplesRendered = render<double>(
+            plugin, automation, midiSchedule, *outWriter, totalInputLength, range, tailDetector,
+            stats, audit
+        );
+    } else {
+        numSamplesRendered = render<float>(
+            plugin, automation, midiSchedule, *outWriter, totalInputLength, range, tailDetector,
+            stats, audit
+        );
+    }
+
+    // destroying the writer finalizes the file header and flushes the stream
+    outWriter.reset();
+
+    // the writer ignores failed writes, so they're only known from the stream
+    if (writeStatistics.writeFailed) {
+        throw CLIException("Couldn't write all of the output. The disk may be full");
+    }
+
+    // the length of the input read from stdin is only known once it has been read
+    if (stdinInput != nullptr) {
+        totalInputLength =
+            std::max(totalInputLength, static_cast<size_t>(stdinInput->getNumSamplesRead()));
+    }
+
+    if (statsOpt) {
+        statsOpt->setRenderInfo({
+            .sampleRate = sampleRate,
+            .blockSize = blockSize,
+            .doublePrecision = processInDoublePrecision,
+            .pipelined = usePipeline,
+            .numSamples = numSamplesRendered,
+            .latencySamples = plugin.getLatencySamples(),
+            .tailLengthSeconds = plugin.getTailLengthSeconds(),
+            .numBytesWritten = static_cast<size_t>(writeStatistics.numBytesWritten),
+            .numWriteCalls = writeStatistics.numWriteCalls,
+        });
+
+        if (*statsFormatOpt == OutputFormat::json) {
+            outputResult(statsOpt->toJson().dump(4), statsFilePath);
+        } else {
+            outputResult(statsOpt->toString(), statsFilePath);
+        }
+    }
+
+    if (verbose) {
+        std::println(
+            stderr, "Wrote {} bytes to the output using {} write calls.",
+            writeStatistics.numBytesWritten, writeStatistics.numWriteCalls
+        );
+        if (tailDetector != nullptr) {
+            std::println(
+                stderr, "Rendered a tail of {:.3f} seconds.",
+                static_cast<double>(tailDetector->getLength()) / sampleRate
+            );
+        }
+    }
+
+    // the output has been written by now, so it can be inspected even if the audit fails
+    if (auditOpt) {
+        std::print(stderr, "{}", auditOpt->toString());
+        if (failOnRealtimeViolations && auditOpt->getNumViolations() > 0) {
+            throw RealtimeViolationError(
+                std::format(
+                    "The plugin performed {} operations that aren't real-time safe",
+                    auditOpt->getNumViolations()
+                ),
+                3
+            );
+        }
+    }
+
+    auto outputLength =
+        std::min(totalInputLength, range.end) - std::min(totalInputLength, range.start);
+    if (tailDetector != nullptr) {
+        outputLength += tailDetector->getLength();
+    }
+    return outputLength;
+}
+
+/**
+ * Writes the given range of the buffer to the output.
+ * AudioFormatWriter only accepts single precision samples,
+ * so double precision samples are converted using the given buffer.
+ */
+template<typename SampleType>
+static void writeToOutput(
+    juce::AudioFormatWriter& writer, const juce::AudioBuffer<SampleType>& buffer, int startSample,
+    int numSamples, juce::AudioBuffer<float>& conversionBuffer
+) {
+    if constexpr (std::is_same_v<SampleType, float>) {
+        writer.writeFromAudioSampleBuffer(buffer, startSample, numSamples);
+    } else {
+        for (int channel = 0; channel < conversionBuffer.getNumChannels(); channel++) {
+            const auto* source = buffer.getReadPointer(channel, startSample);
+            std::transform(
+                source, source + numSamples, conversionBuffer.getWritePointer(channel),
+                [](SampleType sample) { return static_cast<float>(sample); }
+            );
+        }
+        writer.writeFromAudioSampleBuffer(conversionBuffer, 0, numSamples);
+    }
+}
+
+template<typename SampleType>
+size_t ProcessCommand::render(
+    juce::AudioPluginInstance& plugin, ResolvedAutomation& automation, MidiSchedule& midiSchedule,
+    juce::AudioFormatWriter& writer, size_t totalInputLength, const RenderRange& range,
+    TailDetector* tailDetector, RenderStats* stats, RealtimeAudit* audit
+) {
+    using Stage = RenderStats::Stage;
+
+    const auto latency = static_cast<size_t>(plugin.getLatencySamples());
+    // the length of the input read from stdin is only known once it has ended.
+    // stdin is read by the decoding thread, while the encoding thread needs it to find the tail.
+    constexpr auto unknownLength = std::numeric_limits<size_t>::max();
+    std::atomic<size_t> inputLength{ unknownLength };
+    auto updateInputLength = [&] {
+        if (stdinInput == nullptr) {
+            inputLength = totalInputLength;
+        } else if (stdinInput->hasEnded()) {
+            inputLength =
+                std::max(totalInputLength, static_cast<size_t>(stdinInput->getNumSamplesRead()));
+        }
+    };
+    updateInputLength();
+    // the inputs end early if only a part of them is rendered
+    auto getInputEnd = [&] { return std::min(inputLength.load(), range.end); };
+
+    // rendering continues while there's input, and then until the latency has been made up for
+    // and the tail has ended, if it's rendered
+    auto isRenderRemaining = [&](size_t sampleIndex) {
+        const auto inputEnd = getInputEnd();
+        if (inputEnd == unknownLength || sampleIndex < inputEnd + latency) {
+            return true;
+        }
+        return tailDetector != nullptr && !tailDetector->hasEnded();
+    };
+    const auto totalNumInputChannels = getTotalNumInputChannels(plugin.getBusesLayout());
+    const auto totalNumOutputChannels = getTotalNumOutputChannels(plugin.getBusesLayout());
+    const auto numChannels = std::max(totalNumInputChannels, totalNumOutputChannels);
 
     juce::MidiBuffer midiBuffer;
-    size_t sampleIndex = 0;
-    int samplesSkipped = 0;
-    while (sampleIndex < totalInputLength + static_cast<size_t>(latency)) {
-        sampleBuffer.clear();
-        renderAudioInput(sampleBuffer, sampleIndex);
-
-        // populate MIDI buffer with the MIDI events
-        // falling into the current processing block.
-        // we simply take MIDI events from all tracks and supply them to the buffer -
-        // if the user only wants a single track of a multi-track MIDI file,
-        // they should extract that track into a separate MIDI file.
-        midiBuffer.clear();
-        for (int i = 0; i < midiFile.getNumTracks(); i++) {
-            auto midiTrack = midiFile.getTrack(i);
-
-            for (auto& meh : *midiTrack) {
-                auto timestampSamples = secondsToSamples(meh->message.getTimeStamp(), sampleRate);
-                if (timestampSamples >= sampleIndex &&
-                    timestampSamples < sampleIndex + static_cast<size_t>(blockSize)) {
-                    midiBuffer.addEvent(meh->message, (int) (timestampSamples - sampleIndex));
-                }
+    auto processBlock = [&](juce::AudioBuffer<SampleType>& buffer, size_t sampleIndex) {
+        // process with plugin, split into sub-blocks if automation
+        // is supposed to be applied more often than once per block
+        int subBlockStart = 0;
+        while (subBlockStart < blockSize) {
+            const auto subBlockIndex = sampleIndex + static_cast<size_t>(subBlockStart);
+
+            // apply automation
+            {
+                RenderStats::ScopedTimer timer{ stats, Stage::automationApply };
+                Automation::applyParameters(automation, subBlockIndex);
             }
+
+            const auto subBlockLength =
+                getSubBlockLength(automation, subBlockIndex, blockSize - subBlockStart);
+            juce::AudioBuffer<SampleType> subBlock{ buffer.getArrayOfWritePointers(),
+                buffer.getNumChannels(), subBlockStart, subBlockLength };
+
+            // populate MIDI buffer with the MIDI events
+            // falling into the current sub-block
+            {
+                RenderStats::ScopedTimer timer{ stats, Stage::midiFill };
+                midiSchedule.fillBuffer(midiBuffer, subBlockIndex, subBlockLength);
+            }
+
+            {
+                RenderStats::ScopedTimer timer{ stats, Stage::processBlock };
+                RealtimeAudit::ScopedProcessBlock auditedBlock{ audit, subBlockIndex };
+                plugin.processBlock(subBlock, midiBuffer);
+            }
+
+            subBlockStart += subBlockLength;
         }
+    };
 
-        // apply automation
-        Automation::applyParameters(*plugin, automation, sampleIndex);
+    // only needed for double precision processing
+    juce::AudioBuffer<float> conversionBuffer;
+    if constexpr (!std::is_same_v<SampleType, float>) {
+        conversionBuffer.setSize(static_cast<int>(writer.getNumChannels()), blockSize);
+    }
 
-        // process with plugin
-        plugin->processBlock(sampleBuffer, midiBuffer);
+    // quiet samples at the end of the tail found so far, which are held back
+    // until it's known whether the tail continues after them
+    juce::AudioBuffer<float> heldSamples;
+    int numHeld = 0;
+    if (tailDetector != nullptr) {
+        heldSamples.setSize(
+            static_cast<int>(writer.getNumChannels()),
+            static_cast<int>(tailDetector->getWindowLength()) + blockSize
+        );
+    }
+    auto holdSamples = [&](const juce::AudioBuffer<SampleType>& buffer, int startSample,
+                           int numSamples) {
+        for (int channel = 0; channel < heldSamples.getNumChannels(); channel++) {
+            const auto* source = buffer.getReadPointer(channel, startSample);
+            std::transform(
+                source, source + numSamples, heldSamples.getWritePointer(channel, numHeld),
+                [](SampleType sample) { return static_cast<float>(sample); }
+            );
+        }
+        numHeld += numSamples;
+    };
 
-        // skip the first samples that are just empty because of the plugin's latency
+    auto writeBlock = [&](const juce::AudioBuffer<SampleType>& buffer, size_t sampleIndex) {
+        RenderStats::ScopedTimer timer{ stats, Stage::write };
+
+        // skip the pre-roll and the first samples that are just empty
+        // because of the plugin's latency
         int startSample = 0;
-        if (samplesSkipped < latency) {
-            startSample = std::min<int>(latency - samplesSkipped, blockSize);
-            samplesSkipped += startSample;
+        const auto writeStart = range.start + latency;
+        if (sampleIndex < writeStart) {
+            startSample = static_cast<int>(std::min<size_t>(writeStart - sampleIndex, blockSize));
+        }
+
+        // when the whole input is rendered without a tail, whole blocks are written
+        // until the latency has been made up for
+        int tailStart = blockSize;
+        const auto inputEnd = getInputEnd();
+        if ((tailDetector != nullptr || range.end != unknownLength) && inputEnd != unknownLength) {
+            const auto tailIndex = inputEnd + latency;
+            tailStart = tailIndex > sampleIndex
+                            ? static_cast<int>(std::min<size_t>(tailIndex - sampleIndex, blockSize))
+                            : 0;
+            tailStart = std::max(tailStart, startSample);
         }
 
         // write to output
-        if (startSample < blockSize) {
-            outWriter->writeFromAudioSampleBuffer(
-                sampleBuffer, startSample, (int) blockSize - startSample
-            );
+        if (startSample < tailStart) {
+            writeToOutput(writer, buffer, startSample, tailStart - startSample, conversionBuffer);
+        }
+        // blocks rendered ahead while the end of the tail was being found are dropped
+        if (tailDetector == nullptr || tailStart == blockSize || tailDetector->hasEnded()) {
+            return;
         }
 
-        sampleIndex += static_cast<size_t>(blockSize);
+        const auto numTailSamples = blockSize - tailStart;
+        const auto numLoud = tailDetector->analyse(
+            buffer, static_cast<int>(writer.getNumChannels()), tailStart, numTailSamples
+        );
+        if (numLoud > 0) {
+            // the quiet samples held back turned out to be within the tail
+            if (numHeld > 0) {
+                writer.writeFromAudioSampleBuffer(heldSamples, 0, numHeld);
+                numHeld = 0;
+            }
+            writeToOutput(writer, buffer, tailStart, numLoud, conversionBuffer);
+        }
+        if (!tailDetector->hasEnded()) {
+            holdSamples(buffer, tailStart + numLoud, numTailSamples - numLoud);
+        }
+    };
+
+    auto renderInputBlock = [&](juce::AudioBuffer<SampleType>& buffer, size_t sampleIndex) {
+        RenderStats::ScopedTimer timer{ stats, Stage::inputRender };
+        buffer.clear();
+
+        // the tail is rendered from silence, so nothing past the end of the inputs is read
+        if (tailDetector != nullptr && sampleIndex >= getInputEnd()) {
+            return;
+        }
+        renderAudioInput(buffer, sampleIndex);
+        updateInputLength();
+
+        // generators, and inputs that are only rendered in part, don't stop by themselves
+        const auto inputEnd = getInputEnd();
+        if (tailDetector != nullptr && inputEnd != unknownLength &&
+            sampleIndex + static_cast<size_t>(blockSize) > inputEnd) {
+            const auto silenceStart = static_cast<int>(inputEnd - sampleIndex);
+            buffer.clear(silenceStart, blockSize - silenceStart);
+        }
+    };
+
+    if (stats != nullptr) {
+        stats->startRender();
+    }
+
+    // rendering starts with the pre-roll, at the same position in the inputs, MIDI and automation
+    midiSchedule.seek(range.preRollStart);
+    size_t sampleIndex = range.preRollStart;
+    if (!usePipeline) {
+        juce::AudioBuffer<SampleType> sampleBuffer(numChannels, blockSize);
+        for (; isRenderRemaining(sampleIndex); sampleIndex += static_cast<size_t>(blockSize)) {
+            renderInputBlock(sampleBuffer, sampleIndex);
+            processBlock(sampleBuffer, sampleIndex);
+            writeBlock(sampleBuffer, sampleIndex);
+        }
+
+        if (stats != nullptr) {
+            stats->endRender();
+        }
+        return sampleIndex - range.preRollStart;
+    }
+
+    // read the inputs and write the output on separate threads,
+    // so the plugin never has to wait for file I/O
+    enum Stage : size_t { decodeStage, processStage, encodeStage, numStages };
+    BlockPipeline<SampleType> pipeline{ numStages, static_cast<size_t>(pipelineDepth),
+        numChannels, blockSize };
+
+    // the threads are joined even if starting the second one throws. they're asked to stop then,
+    // which cancels the pipeline, so they don't wait for blocks that will never come.
+    std::exception_ptr decodeError;
+    std::jthread decodeThread{ [&](std::stop_token stopToken) {
+        std::stop_callback cancelOnStop{ stopToken, [&] { pipeline.cancel(); } };
+        try {
+            for (; isRenderRemaining(sampleIndex); sampleIndex += static_cast<size_t>(blockSize)) {
+                auto* block = pipeline.acquire(decodeStage);
+                if (block == nullptr) {
+                    return;
+                }
+
+                block->sampleIndex = sampleIndex;
+                renderInputBlock(block->buffer, sampleIndex);
+                pipeline.release(decodeStage);
+            }
+            pipeline.finish(decodeStage);
+        } catch (...) {
+            decodeError = std::current_exception();
+            pipeline.cancel();
+        }
+    } };
+
+    std::exception_ptr encodeError;
+    std::jthread encodeThread{ [&](std::stop_token stopToken) {
+        std::stop_callback cancelOnStop{ stopToken, [&] { pipeline.cancel(); } };
+        try {
+            while (auto* block = pipeline.acquire(encodeStage)) {
+                writeBlock(block->buffer, block->sampleIndex);
+                pipeline.release(encodeStage);
+            }
+        } catch (...) {
+            encodeError = std::current_exception();
+            pipeline.cancel();
+        }
+    } };
+
+    // the plugin stays on the thread it was created on
+    std::exception_ptr processError;
+    try {
+        while (auto* block = pipeline.acquire(processStage)) {
+            processBlock(block->buffer, block->sampleIndex);
+            pipeline.release(processStage);
+        }
+        pipeline.finish(processStage);
+    } catch (...) {
+        processError = std::current_exception();
+        pipeline.cancel();
+    }
+
+    decodeThread.join();
+    encodeThread.join();
+
+    if (stats != nullptr) {
+        stats->endRender();
     }
+
+    for (const auto& error : { processError, decodeError, encodeError }) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return sampleIndex - range.preRollStart;
+}
+
+double ProcessCommand::getMaxTailSeconds(const juce::AudioPluginInstance& plugin) const {
+    if (maxTailSecondsOpt) {
+        return *maxTailSecondsOpt;
+    }
+
+    // plugins that don't know their tail length report zero, or infinity if it never ends
+    const auto reportedTailSeconds = plugin.getTailLengthSeconds();
+    if (reportedTailSeconds > 0.0 && std::isfinite(reportedTailSeconds)) {
+        return reportedTailSeconds + tailWindowSeconds;
+    }
+    return defaultMaxTailSeconds;
+}
+
+Hertz ProcessCommand::getSampleRate() const {
+    return inputSampleRate != 0.0 ? inputSampleRate : argSampleRate;
+}
+
+int ProcessCommand::getSubBlockLength(
+    ResolvedAutomation& automation, size_t subBlockIndex, int maxLength
+) const {
+    if (!automationResolutionOpt) {
+        // automation is only applied once per block
+        return maxLength;
+    }
+
+    auto length = maxLength;
+    if (*automationResolutionOpt > 0) {
+        length = std::min(length, *automationResolutionOpt);
+    }
+
+    // end the sub-block where the next keyframe starts
+    const auto nextKeyframeTime = Automation::getNextKeyframeTime(automation, subBlockIndex);
+    if (nextKeyframeTime < subBlockIndex + static_cast<size_t>(length)) {
+        length = static_cast<int>(nextKeyframeTime - subBlockIndex);
+    }
+
+    return length;
 }
 
 std::string ProcessCommand::validateInputFileSampleRate(const std::string& arg) {
-    auto f = parse::stringToFile(arg);
-    if (std::unique_ptr<juce::AudioFormatReader> inputFileReader{
-            audioFormatManager.createReaderFor(f) }) {
-        if (inputSampleRate == 0.0) {
-            inputSampleRate = inputFileReader->sampleRate;
-            return {};
+    double fileSampleRate{ 0.0 };
+
+    if (arg == standardStreamPath) {
+        // stdin can only be read once, so the reader is kept for parseAudioFileInput
+        if (pendingStdinReader != nullptr || stdinInput != nullptr) {
+            return "Only one input can be read from stdin";
         }
-        if (!juce::exactlyEqual(inputSampleRate, inputFileReader->sampleRate)) {
-            return std::format("Mismatched sample rate in input file: {}", arg);
+        try {
+            pendingStdinReader = openStdinInput();
+        } catch (const CLI::Error& e) {
+            return e.what();
         }
-        return {};
+        fileSampleRate = pendingStdinReader->sampleRate;
+
+        // the length of streamed input is tracked at its own sample rate
+        if (inputSampleRate != 0.0 && !juce::exactlyEqual(inputSampleRate, fileSampleRate)) {
+            return std::format(
+                "Audio read from stdin can't be resampled. Its sample rate {} must match the "
+                "sample rate of the inputs before it, {}",
+                fileSampleRate, inputSampleRate
+            );
+        }
+    } else if (std::unique_ptr<juce::AudioFormatReader> inputFileReader{
+                   audioFormatManager.createReaderFor(parse::stringToFile(arg)) }) {
+        fileSampleRate = inputFileReader->sampleRate;
     } else {
         return std::format("Found the file but couldn't open it as audio: {}", arg);
     }
+
+    // inputs with other sample rates are resampled to the first input's
+    if (inputSampleRate == 0.0) {
+        inputSampleRate = fileSampleRate;
+    }
+    return {};
 }
 
 std::string ProcessCommand::validateInputGeneratorSampleRate(const std::string& arg) {
@@ -252,12 +799,151 @@ std::string ProcessCommand::validateInputGeneratorSampleRate(const std::string&
 
 std::unique_ptr<juce::AudioFormatReader>
 ProcessCommand::parseAudioFileInput(const std::string& audioFilePath) {
-    auto f = parse::stringToFile(audioFilePath);
-    if (std::unique_ptr<juce::AudioFormatReader> inputFileReader{
-            audioFormatManager.createReaderFor(f) }) {
-        return inputFileReader;
+    if (audioFilePath == standardStreamPath) {
+        stdinInput = pendingStdinReader.get();
+        return std::move(pendingStdinReader);
     }
-    throw FileLoadError{ std::format("Couldn't read audio file: {}", audioFilePath), 97 };
+
+    auto reader = openAudioFile(parse::stringToFile(audioFilePath));
+    if (reader == nullptr) {
+        throw FileLoadError{ std::format("Couldn't read audio file: {}", audioFilePath), 97 };
+    }
+
+    if (!juce::exactlyEqual(reader->sampleRate, inputSampleRate)) {
+        std::println(
+            stderr, "Resampling {} from {} Hz to {} Hz.", audioFilePath, reader->sampleRate,
+            inputSampleRate
+        );
+        return std::make_unique<ResamplingAudioFormatReader>(
+            std::move(reader), inputSampleRate, resamplingQuality
+        );
+    }
+    return reader;
+}
+
+std::unique_ptr<juce::AudioFormatReader> ProcessCommand::openAudioFile(const juce::File& f) {
+    // uncompressed formats like WAV and AIFF can be read from a memory-mapped file,
+    // which turns block reads into conversions straight from the page cache.
+    // mapping the entire file is fine, since pages are only loaded once they're read.
+    if (auto* format = audioFormatManager.findFormatForFileExtension(f.getFileExtension())) {
+        if (std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader{
+                format->createMemoryMappedReader(f) }) {
+            if (mappedReader->mapEntireFile()) {
+                return mappedReader;
+            }
+        }
+    }
+
+    // compressed formats, or files that couldn't be mapped, are streamed instead
+    return std::unique_ptr<juce::AudioFormatReader>{ audioFormatManager.createReaderFor(f) };
+}
+
+std::unique_ptr<PcmStreamReader> ProcessCommand::openStdinInput() const {
+    if (stdinFormat == StreamFormat::wav) {
+        return PcmStreamReader::createForWavStream(new StandardInputStream());
+    }
+
+    // raw PCM doesn't describe itself
+    if (!stdinChannelsOpt || !stdinSampleRateOpt) {
+        throw ParseError{
+            "Raw PCM read from stdin needs --stdinChannels and --stdinSampleRate", 172
+        };
+    }
+    return std::make_unique<PcmStreamReader>(
+        new StandardInputStream(), *stdinSampleRateOpt, *stdinChannelsOpt,
+        getPcmEncoding(stdinFormat), std::nullopt
+    );
+}
+
+std::unique_ptr<juce::AudioFormatWriter> ProcessCommand::createOutputWriter(
+    Hertz sampleRate, int numChannels, int bitDepth, juce::int64 expectedSize,
+    BufferedFileOutputStream::Statistics& statistics
+) const {
+    if (writeToStdout) {
+        auto encoding = getPcmEncoding(stdoutFormat);
+        if (stdoutFormat == StreamFormat::wav) {
+            // 32 bit WAV holds floats
+            encoding = { .bitsPerSample = static_cast<unsigned int>(bitDepth),
+                .floatingPoint = bitDepth == 32 };
+        }
+        return std::make_unique<PcmStreamWriter>(
+            new StandardOutputStream(statistics), sampleRate,
+            static_cast<unsigned int>(numChannels), encoding, stdoutFormat == StreamFormat::wav
+        );
+    }
+
+    const auto fileFormat = getOutputFileFormat();
+    juce::FlacAudioFormat flacFormat;
+    if (fileFormat == AudioFileFormat::flac &&
+        !flacFormat.getPossibleBitDepths().contains(bitDepth)) {
+        throw CLIException(std::format(
+            "FLAC output can't have a bit depth of {}. Use --bitDepth to choose 16 or 24 bits",
+            bitDepth
+        ));
+    }
+
+    outputFilePath.deleteFile();
+    auto bufferedOutputStream = std::make_unique<BufferedFileOutputStream>(
+        outputFilePath, writeBufferSize, expectedSize, statistics
+    );
+    if (!bufferedOutputStream->openedOk()) {
+        throw CLIException(
+            "Could not create output stream to write to file " + outputFilePath.getFullPathName()
+        );
+    }
+    std::unique_ptr<juce::OutputStream> outputStream{ std::move(bufferedOutputStream) };
+
+    // like WAV, Wave64 holds floats at 32 bits
+    const PcmEncoding pcmEncoding{ .bitsPerSample = static_cast<unsigned int>(bitDepth),
+        .floatingPoint = bitDepth == 32 };
+    const auto writerOptions = juce::AudioFormatWriterOptions{}
+                                   .withSampleRate(sampleRate)
+                                   .withNumChannels(numChannels)
+                                   .withBitsPerSample(bitDepth);
+
+    // the writers take over the stream
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    switch (fileFormat) {
+    case AudioFileFormat::wav:
+        // switches to RF64 by itself once the file exceeds 4 GB
+        writer = juce::WavAudioFormat{}.createWriterFor(outputStream, writerOptions);
+        break;
+    case AudioFileFormat::w64:
+        writer = std::make_unique<Wave64Writer>(
+            outputStream.release(), sampleRate, static_cast<unsigned int>(numChannels),
+            pcmEncoding
+        );
+        break;
+    case AudioFileFormat::raw:
+        writer = std::make_unique<PcmStreamWriter>(
+            outputStream.release(), sampleRate, static_cast<unsigned int>(numChannels),
+            getPcmEncoding(StreamFormat::f32le), false
+        );
+        break;
+    case AudioFileFormat::flac:
+        writer = flacFormat.createWriterFor(outputStream, writerOptions);
+        break;
+    }
+
+    if (writer == nullptr) {
+        throw CLIException(std::format(
+            "Could not create a writer for {} channels at {} bits for the output file",
+            numChannels, bitDepth
+        ));
+    }
+    return writer;
+}
+
+AudioFileFormat ProcessCommand::getOutputFileFormat() const {
+    if (outputFileFormatOpt) {
+        return *outputFileFormatOpt;
+    }
+
+    const auto extension = outputFilePath.getFileExtension().toLowerCase().toStdString();
+    if (audioFileExtensionMap.contains(extension)) {
+        return audioFileExtensionMap.at(extension);
+    }
+    return AudioFileFormat::wav;
 }
 
 std::size_t ProcessCommand::getLengthOfLongestAudioInput(Hertz sampleRate) const {
@@ -442,24 +1128,35 @@ void ProcessCommand::negotiateBusesLayout(juce::AudioPluginInstance& plugin) {
     }
 }
 
-void ProcessCommand::prepareAudioInputs(Hertz currentSampleRate, int currentBlockSize) {
+void ProcessCommand::prepareAudioInputs(
+    Hertz currentSampleRate, int currentBlockSize, size_t startSample
+) {
     using Reader = std::unique_ptr<juce::AudioFormatReader>;
     using Gen = GeneratorInputBus;
 
+    int maxNumReaderChannels{ 0 };
+
     // clang-format off
     for (auto& inputSource : audioInputs) {
         std::visit(
             InputSourceVisitor{
-                [&](Reader&) {},
-                [&](Gen& gen) { return gen.prepare(currentSampleRate, static_cast<juce::uint32>(currentBlockSize)); }
+                [&](Reader& reader) { maxNumReaderChannels = std::max(maxNumReaderChannels, (int) reader->numChannels); },
+                [&](Gen& gen) {
+                    gen.prepare(currentSampleRate, static_cast<juce::uint32>(currentBlockSize));
+                    // readers are read from wherever rendering starts, generators have to catch up
+                    gen.skip(startSample);
+                }
             },
             inputSource
         );
     }
     // clang-format on
+
+    readBuffer.setSize(maxNumReaderChannels, currentBlockSize);
 }
 
-void ProcessCommand::renderAudioInput(juce::AudioBuffer<float>& buffer, size_t sampleIndex) {
+template<typename SampleType>
+void ProcessCommand::renderAudioInput(juce::AudioBuffer<SampleType>& buffer, size_t sampleIndex) {
     using Reader = std::unique_ptr<juce::AudioFormatReader>;
     using Gen = GeneratorInputBus;
 
@@ -470,22 +1167,43 @@ void ProcessCommand::renderAudioInput(juce::AudioBuffer<float>& buffer, size_t s
         std::visit(
             InputSourceVisitor{
                 [&](Reader& inputFile) {
+                    // readers only produce single precision samples, which represent
+                    // 16 and 24 bit PCM exactly. for double precision processing,
+                    // read into a separate buffer and convert from there.
+                    float* const* destChannels;
+                    if constexpr (std::is_same_v<SampleType, float>) {
+                        destChannels = buffer.getArrayOfWritePointers() + bufferChannelIndex;
+                    } else {
+                        destChannels = readBuffer.getArrayOfWritePointers();
+                    }
+
                     auto success = inputFile->read(
-                        buffer.getArrayOfWritePointers() + bufferChannelIndex,
-                        (int) inputFile->numChannels, static_cast<juce::int64>(sampleIndex),
-                        (int) blockSize
+                        destChannels, (int) inputFile->numChannels,
+                        static_cast<juce::int64>(sampleIndex), (int) blockSize
                     );
                     if (!success)
                         throw FileLoadError(
                             std::format("Error reading input file {}", inputFileIndex), 103
                         );
+
+                    if constexpr (!std::is_same_v<SampleType, float>) {
+                        for (unsigned int channel = 0; channel < inputFile->numChannels;
+                             channel++) {
+                            const auto* source = readBuffer.getReadPointer((int) channel);
+                            std::copy(
+                                source, source + blockSize,
+                                buffer.getWritePointer((int) (bufferChannelIndex + channel))
+                            );
+                        }
+                    }
+
                     inputFileIndex++;
                     bufferChannelIndex += inputFile->numChannels;
                 },
                 [&](Gen& gen) {
                     const auto numChannels =
                         static_cast<std::size_t>(gen.getChannelLayout().size());
-                    auto block = juce::dsp::AudioBlock<float>{ buffer }.getSubsetChannelBlock(
+                    auto block = juce::dsp::AudioBlock<SampleType>{ buffer }.getSubsetChannelBlock(
                         bufferChannelIndex, numChannels
                     );
                     gen.processChannels(block);
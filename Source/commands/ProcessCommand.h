@@ -1,36 +1,112 @@
 #pragma once
 
-#include "CLICommand.h"
+#include "AudioStreams.h"
+#include "BufferedFileOutputStream.h"
+#include "HostThread.h"
+#include "MidiSchedule.h"
+#include "PluginCommand.h"
 #include "PluginProcess.h"
+#include "RealtimeAudit.h"
+#include "RenderStats.h"
+#include "Resampler.h"
+#include "TailDetector.h"
+#include "Utils.h"
 
 #include <cstddef>
 #include <cstdio>
 #include <juce_audio_formats/juce_audio_formats.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
-class ProcessCommand : public CLICommand {
+class ProcessCommand : public PluginCommand {
   public:
     ProcessCommand() { audioFormatManager.registerBasicFormats(); }
     std::shared_ptr<CLI::App> createApp() override;
 
     void execute() override;
+    void executeWithPlugin(juce::AudioPluginInstance& plugin) override;
+
+    /**
+     * Processes the inputs with an existing plugin instance and writes the output file.
+     * Negotiates the plugin's buses layout and prepares it for playback, but doesn't apply
+     * the preset or release the plugin's resources afterwards.
+     *
+     * Only the audio is rendered on the calling thread. If a host thread is set, the plugin's
+     * other calls, like setting its buses layout and preparing it, are made on that thread.
+     *
+     * @param plugin The plugin instance. Must not be prepared for playback.
+     * @return The length of the output in samples.
+     */
+    std::size_t process(juce::AudioPluginInstance& plugin);
+
+    /**
+     * Makes process call the plugin on the given thread for everything but rendering audio.
+     * Needed when processing on a different thread than the plugin was created on.
+     */
+    void setHostThread(HostThread& thread) { hostThread = &thread; }
 
   private:
+    /* The part of the inputs to render, as sample indices */
+    struct RenderRange {
+        // where rendering starts, which is earlier than the range's start if there's a pre-roll
+        size_t preRollStart{ 0 };
+        size_t start{ 0 };
+        // the maximum value if the inputs are rendered until they end
+        size_t end{ std::numeric_limits<size_t>::max() };
+    };
+
+    // The sample rate of the inputs, or the one provided by the user if there are none
+    Hertz getSampleRate() const;
     std::string validateInputFileSampleRate(const std::string& arg);
     std::string validateInputGeneratorSampleRate(const std::string& arg);
+    // Opens an input file, resampling it if its sample rate differs from the first input's
     std::unique_ptr<juce::AudioFormatReader> parseAudioFileInput(const std::string& audioFilePath);
+    // Opens an audio file at its own sample rate, or returns nullptr if it can't be read
+    std::unique_ptr<juce::AudioFormatReader> openAudioFile(const juce::File& f);
+    // Reads the header of the audio on stdin, if there is one
+    std::unique_ptr<PcmStreamReader> openStdinInput() const;
+    // The format of the output file, as given or as implied by its extension
+    AudioFileFormat getOutputFileFormat() const;
+    // Creates the writer for the output file, or for stdout
+    std::unique_ptr<juce::AudioFormatWriter> createOutputWriter(
+        Hertz sampleRate, int numChannels, int bitDepth, juce::int64 expectedSize,
+        BufferedFileOutputStream::Statistics& statistics
+    ) const;
     std::size_t getLengthOfLongestAudioInput(Hertz sampleRate) const;
     // Returns zero if there are no inputs
     int getBitDepthOfInput() const;
     juce::Array<juce::AudioChannelSet> getInputBusesLayoutFromAudioInputs() const;
     juce::Array<juce::AudioChannelSet> getOutputBusesLayout(const juce::AudioPluginInstance& plugin) const;
     void negotiateBusesLayout(juce::AudioPluginInstance& plugin);
-    void prepareAudioInputs(Hertz currentSampleRate, int currentBlockSize);
-    void renderAudioInput(juce::AudioBuffer<float>& buffer, size_t sampleIndex);
+    // Prepares the inputs to be read from the given sample on
+    void prepareAudioInputs(Hertz currentSampleRate, int currentBlockSize, size_t startSample);
+    template<typename SampleType>
+    void renderAudioInput(juce::AudioBuffer<SampleType>& buffer, size_t sampleIndex);
+    /**
+     * Renders the inputs through the plugin into the writer.
+     *
+     * @param range The part of the inputs to render. The output of the pre-roll is discarded.
+     * @param tailDetector Finds the end of the plugin's tail to render after the inputs,
+     * or nullptr to only make up for the plugin's latency.
+     * @param audit Counts the operations in processBlock that aren't real-time safe,
+     * or nullptr to not audit them.
+     * @return The amount of samples rendered, including the ones rendered ahead and not written.
+     */
+    template<typename SampleType>
+    size_t render(
+        juce::AudioPluginInstance& plugin, ResolvedAutomation& automation,
+        MidiSchedule& midiSchedule, juce::AudioFormatWriter& writer, size_t totalInputLength,
+        const RenderRange& range, TailDetector* tailDetector, RenderStats* stats,
+        RealtimeAudit* audit
+    );
+    // The longest tail to render, as given or as reported by the plugin
+    double getMaxTailSeconds(const juce::AudioPluginInstance& plugin) const;
+    // Returns the length of the sub-block to process next, depending on the automation resolution
+    int getSubBlockLength(ResolvedAutomation& automation, size_t subBlockIndex, int maxLength) const;
 
     // Strings from CLI to be parsed into audio input sources
     std::vector<std::string> argInputSources;
@@ -38,14 +114,38 @@ class ProcessCommand : public CLICommand {
     std::string argPluginPath;
     // String from CLI to be parsed into a File object
     std::string argOutPath;
+    // String from CLI to be parsed into an AudioFileFormat
+    std::string argOutFormat;
     // String from CLI to be parsed into a File object
     std::string argStatePath;
     // String from CLI to be parsed into a Generator
     std::string argGenerator;
     // String from CLI to be parsed into a File object
     std::string argParamsFile;
+    // String from CLI to be parsed into an OutputFormat
+    std::string argStatsFormat;
+    // String from CLI to be parsed into a File object
+    std::string argStatsPath;
+    // String from CLI to be parsed into a StreamFormat
+    std::string argStdinFormat;
+    // String from CLI to be parsed into a StreamFormat
+    std::string argStdoutFormat;
+    // String from CLI to be parsed into a ResamplingQuality
+    std::string argResampleQuality;
+    // String from CLI to be parsed into a duration
+    std::string argStart;
+    // String from CLI to be parsed into a duration
+    std::string argDuration;
+    // String from CLI to be parsed into a duration
+    std::string argPreRoll;
+    // String from CLI to be parsed into an amplitude
+    std::string argTailThreshold;
+    // String from CLI to be parsed into a duration
+    std::string argTailWindow;
+    // String from CLI to be parsed into a duration
+    std::string argMaxTail;
 
-    // Sample rate found in audio inputs for validation
+    // Sample rate of the first audio input, which the other inputs are resampled to
     double inputSampleRate{ 0.0 };
 
     // Sample rate provided by user
@@ -57,11 +157,49 @@ class ProcessCommand : public CLICommand {
     std::optional<juce::File> presetFileOpt;
     juce::File statePath;
     juce::File outputFilePath;
+    std::optional<AudioFileFormat> outputFileFormatOpt;
+    bool writeToStdout{ false };
     bool overwriteOutputFile;
+    StreamFormat stdinFormat{ StreamFormat::wav };
+    std::optional<unsigned int> stdinChannelsOpt;
+    std::optional<double> stdinSampleRateOpt;
+    StreamFormat stdoutFormat{ StreamFormat::wav };
+    ResamplingQuality resamplingQuality{ ResamplingQuality::best };
+    std::optional<double> outputSampleRateOpt;
+    std::size_t writeBufferSize = 4 * 1024 * 1024;
+    bool verbose{ false };
+    bool auditRealtime{ false };
+    bool failOnRealtimeViolations{ false };
+    std::optional<OutputFormat> statsFormatOpt;
+    juce::File statsFilePath;
     int blockSize = 1024;
+    bool useDoublePrecision{ false };
+    bool usePipeline{ false };
+    int pipelineDepth = 8;
+    std::optional<int> automationResolutionOpt;
+    double startSeconds{ 0.0 };
+    std::optional<double> durationSecondsOpt;
+    double preRollSeconds{ 0.0 };
+    bool renderTail{ false };
+    // -80 dB
+    double tailThreshold{ 0.0001 };
+    double tailWindowSeconds{ 1.0 };
+    std::optional<double> maxTailSecondsOpt;
+    static constexpr double defaultMaxTailSeconds{ 30.0 };
     std::optional<unsigned int> outputChannelCountOpt;
     std::optional<int> outputBitDepthOpt;
     std::optional<juce::File> paramsFileOpt;
     std::vector<std::string> params;
     juce::AudioFormatManager audioFormatManager;
+
+    // The input read from stdin, opened while validating its sample rate
+    std::unique_ptr<PcmStreamReader> pendingStdinReader;
+    // The input read from stdin, owned by audioInputs
+    PcmStreamReader* stdinInput{ nullptr };
+
+    // The thread the plugin's non-audio calls are made on, or nullptr for the calling thread
+    HostThread* hostThread{ nullptr };
+
+    // Scratch buffer for reading audio files when processing in double precision
+    juce::AudioBuffer<float> readBuffer;
 };
@@ -0,0 +1,379 @@
+#include "ServeCommand.h"
+
+#include "AudioStreams.h"
+#include "BenchmarkCommand.h"
+#include "BusLayoutsCommand.h"
+#include "Errors.h"
+#include "ListParametersCommand.h"
+#include "Parsers.h"
+#include "PluginCommand.h"
+#include "PluginProcess.h"
+#include "ProcessCommand.h"
+#include "StateCommand.h"
+#include "Utils.h"
+#include "Validators.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <print>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if JUCE_LINUX || JUCE_MAC
+    #include <cerrno>
+    #include <cstring>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+static double toSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+/* Redirects std::cout into a string while in scope, capturing the output of commands */
+class ScopedOutputCapture {
+  public:
+    ScopedOutputCapture() : previousBuffer(std::cout.rdbuf(captured.rdbuf())) {}
+    ~ScopedOutputCapture() { std::cout.rdbuf(previousBuffer); }
+
+    ScopedOutputCapture(const ScopedOutputCapture&) = delete;
+    ScopedOutputCapture& operator=(const ScopedOutputCapture&) = delete;
+
+    std::string getOutput() const { return captured.str(); }
+
+  private:
+    std::ostringstream captured;
+    std::streambuf* previousBuffer;
+};
+
+static std::unique_ptr<PluginCommand> createCommand(const std::string& name) {
+    if (name == "process") {
+        return std::make_unique<ProcessCommand>();
+    }
+    if (name == "listParameters") {
+        return std::make_unique<ListParametersCommand>();
+    }
+    if (name == "state") {
+        return std::make_unique<StateCommand>();
+    }
+    if (name == "busLayouts") {
+        return std::make_unique<BusLayoutsCommand>();
+    }
+    if (name == "benchmark") {
+        return std::make_unique<BenchmarkCommand>();
+    }
+    throw CLIException(std::format("Unknown command: '{}'", name));
+}
+
+std::shared_ptr<CLI::App> ServeCommand::createApp() {
+    std::shared_ptr<CLI::App> app = std::make_shared<CLI::App>(
+        "Handles requests for other commands, keeping plugins loaded between requests. "
+        "Requests are read as JSON lines from stdin or a Unix domain socket",
+        "serve"
+    );
+
+    // don't break these lines, please
+    // clang-format off
+    app->add_option("--socket", argSocketPath, "Path of a Unix domain socket to listen on instead of reading requests from stdin")
+        ->check(validate::outputPath)
+        ->each([&](std::string arg) { socketPathOpt = parse::stringToFile(arg); });
+    app->add_option("--maxInstances", maxNumInstances, "The amount of plugin instances to keep loaded. When exceeded, the least recently used instance is unloaded")
+        ->check(CLI::PositiveNumber);
+
+    // clang-format on
+    return app;
+}
+
+void ServeCommand::execute() {
+    if (socketPathOpt) {
+        serveUnixSocket();
+        return;
+    }
+
+    serveLines(
+        [] -> std::optional<std::string> {
+            std::string line;
+            if (!std::getline(std::cin, line)) {
+                return std::nullopt;
+            }
+            return line;
+        },
+        [](const std::string& line) { std::cout << line << std::endl; }
+    );
+}
+
+bool ServeCommand::serveLines(const LineReader& readLine, const LineWriter& writeLine) {
+    while (const auto line = readLine()) {
+        if (string_utils::strip(*line).empty()) {
+            continue;
+        }
+
+        bool shutdownRequested = false;
+        const auto response = handleRequest(*line, shutdownRequested);
+        // invalid UTF-8 in messages from plugins shouldn't take the server down
+        writeLine(response.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+
+        if (shutdownRequested) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+nlohmann::json
+ServeCommand::handleRequest(const std::string& requestLine, bool& shutdownRequested) {
+    const auto requestStart = Clock::now();
+    nlohmann::json response{ { "ok", false } };
+
+    try {
+        const auto request = nlohmann::json::parse(requestLine);
+        if (!request.is_object()) {
+            throw CLIException("Requests must be JSON objects");
+        }
+        if (request.contains("id")) {
+            response["id"] = request["id"];
+        }
+
+        const auto commandName = request.value("command", std::string{});
+        if (commandName == "shutdown") {
+            shutdownRequested = true;
+            response["ok"] = true;
+            return response;
+        }
+
+        auto options = request.value("options", nlohmann::json::object());
+        if (!options.is_object() || !options.contains("plugin") || !options["plugin"].is_string()) {
+            throw CLIException("Requests must have an 'options' object containing the 'plugin'");
+        }
+
+        // requests and responses may be exchanged through stdin and stdout, so audio can't be
+        // read from or written to them
+        for (const auto* key : { "input", "output" }) {
+            if (!options.contains(key)) {
+                continue;
+            }
+            const auto& value = options[key];
+            for (const auto& path : value.is_array() ? value : nlohmann::json::array({ value })) {
+                if (path == standardStreamPath) {
+                    throw CLIException(
+                        "Audio can't be streamed through stdin or stdout when serving"
+                    );
+                }
+            }
+        }
+
+        // the preset is applied to the warm instance here, rather than by the command
+        std::optional<juce::File> presetFileOpt;
+        if (options.contains("preset")) {
+            presetFileOpt = parse::stringToFile(options["preset"].get<std::string>());
+            options.erase("preset");
+        }
+
+        // CLI11 expects the arguments reversed
+        auto command = createCommand(commandName);
+        auto arguments = parse::optionsToArguments(options);
+        std::ranges::reverse(arguments);
+        command->createApp()->parse(arguments);
+
+        const auto pluginPath =
+            parse::stringToFile(options["plugin"].get<std::string>()).getFullPathName();
+        const auto loadStart = Clock::now();
+        bool wasLoaded = false;
+        auto& plugin = getWarmPlugin(pluginPath, wasLoaded);
+        const auto loadTime = Clock::now() - loadStart;
+
+        const auto commandStart = Clock::now();
+        std::string output;
+        try {
+            ScopedOutputCapture outputCapture;
+            if (presetFileOpt) {
+                applyPresetFile(plugin, *presetFileOpt);
+            }
+            command->executeWithPlugin(plugin);
+            output = outputCapture.getOutput();
+        } catch (...) {
+            plugin.releaseResources();
+            throw;
+        }
+        plugin.releaseResources();
+        const auto commandTime = Clock::now() - commandStart;
+
+        // binary output, like plugin state, can't be represented as a JSON string
+        if (juce::CharPointer_UTF8::isValidString(output.data(), static_cast<int>(output.size()))) {
+            response["output"] = output;
+        } else {
+            response["outputBase64"] =
+                juce::Base64::toBase64(output.data(), output.size()).toStdString();
+        }
+
+        response["ok"] = true;
+        response["warmInstance"] = wasLoaded;
+        response["timings"] = {
+            { "pluginLoadSeconds", toSeconds(loadTime) },
+            { "commandSeconds", toSeconds(commandTime) },
+        };
+    } catch (const CLI::Error& e) {
+        response["error"] = e.what();
+        response["exitCode"] = e.get_exit_code();
+    } catch (const std::exception& e) {
+        response["error"] = e.what();
+        response["exitCode"] = 1;
+    }
+
+    response["timings"]["totalSeconds"] = toSeconds(Clock::now() - requestStart);
+    return response;
+}
+
+juce::AudioPluginInstance&
+ServeCommand::getWarmPlugin(const juce::String& pluginPath, bool& wasLoaded) {
+    numRequests++;
+
+    if (auto it = warmPlugins.find(pluginPath); it != warmPlugins.end()) {
+        auto& warmPlugin = it->second;
+        warmPlugin.lastUsed = numRequests;
+        warmPlugin.plugin->setStateInformation(
+            warmPlugin.initialState.getData(), static_cast<int>(warmPlugin.initialState.getSize())
+        );
+
+        wasLoaded = true;
+        return *warmPlugin.plugin;
+    }
+
+    // make room by unloading the least recently used instance
+    if (warmPlugins.size() >= maxNumInstances) {
+        warmPlugins.erase(std::ranges::min_element(warmPlugins, {}, [](const auto& entry) {
+                              return entry.second.lastUsed;
+                          }));
+    }
+
+    // the sample rate and block size are only placeholders,
+    // since the process command prepares the plugin with its own
+    const double dummySampleRate{ 48000.0 };
+    const int dummyBlockSize{ 1024 };
+    WarmPlugin warmPlugin{
+        .plugin = PluginUtils::createPluginInstance(pluginPath, dummySampleRate, dummyBlockSize),
+        .initialState = {},
+        .lastUsed = numRequests,
+    };
+    warmPlugin.plugin->getStateInformation(warmPlugin.initialState);
+
+    wasLoaded = false;
+    return *warmPlugins.emplace(pluginPath, std::move(warmPlugin)).first->second.plugin;
+}
+
+#if JUCE_LINUX || JUCE_MAC
+
+void ServeCommand::serveUnixSocket() {
+    const auto socketPath = socketPathOpt->getFullPathName().toStdString();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        throw CLIException(std::format("Socket path is too long: {}", socketPath));
+    }
+    std::ranges::copy(socketPath, address.sun_path);
+
+    // remove a socket left behind by a previous server, but never any other kind of file
+    struct stat existing{};
+    if (::stat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            throw CLIException(std::format("{} exists and is not a socket", socketPath));
+        }
+        ::unlink(socketPath.c_str());
+    }
+
+    const auto listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1) {
+        throw CLIException(std::format("Couldn't create socket: {}", std::strerror(errno)));
+    }
+    if (::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1 ||
+        ::listen(listener, 8) == -1) {
+        const auto error = errno;
+        ::close(listener);
+        throw CLIException(
+            std::format("Couldn't listen on {}: {}", socketPath, std::strerror(error))
+        );
+    }
+    std::println(stderr, "Listening on {}", socketPath);
+
+    // clients are served one after another, each sending any number of requests
+    bool shutdownRequested = false;
+    while (!shutdownRequested) {
+        const auto connection = ::accept(listener, nullptr, nullptr);
+        if (connection == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+    #if JUCE_MAC
+        // a client hanging up early mustn't kill the server with SIGPIPE
+        const int noSigPipe = 1;
+        ::setsockopt(connection, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+        const int sendFlags = 0;
+    #else
+        const int sendFlags = MSG_NOSIGNAL;
+    #endif
+
+        std::string pending;
+        auto readLine = [&] -> std::optional<std::string> {
+            while (true) {
+                if (const auto newline = pending.find('\n'); newline != std::string::npos) {
+                    auto line = pending.substr(0, newline);
+                    pending.erase(0, newline + 1);
+                    return line;
+                }
+
+                char buffer[4096];
+                const auto numRead = ::read(connection, buffer, sizeof(buffer));
+                if (numRead < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (numRead <= 0) {
+                    return std::nullopt;
+                }
+                pending.append(buffer, static_cast<std::size_t>(numRead));
+            }
+        };
+
+        auto writeLine = [&](const std::string& line) {
+            const auto data = line + '\n';
+            std::size_t numWritten = 0;
+            while (numWritten < data.size()) {
+                const auto result = ::send(
+                    connection, data.data() + numWritten, data.size() - numWritten, sendFlags
+                );
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0) {
+                    // the client is gone, its remaining requests will fail to read
+                    return;
+                }
+                numWritten += static_cast<std::size_t>(result);
+            }
+        };
+
+        shutdownRequested = serveLines(readLine, writeLine);
+        ::close(connection);
+    }
+
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+}
+
+#else
+
+void ServeCommand::serveUnixSocket() {
+    throw CLIException("Unix domain sockets are not supported on this platform");
+}
+
+#endif
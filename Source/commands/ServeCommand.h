@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CLICommand.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+
+/**
+ * Runs a server handling requests equivalent to the process, listParameters, state and
+ * busLayouts commands, keeping plugin instances loaded between requests.
+ *
+ * Requests and responses are JSON objects, one per line, exchanged via stdin and stdout
+ * or a Unix domain socket.
+ */
+class ServeCommand : public CLICommand {
+  public:
+    std::shared_ptr<CLI::App> createApp() override;
+
+    void execute() override;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+    using LineReader = std::function<std::optional<std::string>()>;
+    using LineWriter = std::function<void(const std::string&)>;
+
+    /* A loaded plugin instance kept around for later requests */
+    struct WarmPlugin {
+        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        // the plugin's state right after loading, which every request starts from
+        juce::MemoryBlock initialState;
+        // value of the request counter when the instance was last used, for eviction
+        std::uint64_t lastUsed{ 0 };
+    };
+
+    /**
+     * Handles requests until the reader runs out of lines or a shutdown is requested.
+     *
+     * @return Whether a shutdown was requested.
+     */
+    bool serveLines(const LineReader& readLine, const LineWriter& writeLine);
+    nlohmann::json handleRequest(const std::string& requestLine, bool& shutdownRequested);
+    /**
+     * Gets a loaded instance of the plugin, restored to its initial state,
+     * loading it first if necessary.
+     *
+     * @param pluginPath The plugin's full path.
+     * @param wasLoaded Set to whether the plugin was already loaded.
+     */
+    juce::AudioPluginInstance& getWarmPlugin(const juce::String& pluginPath, bool& wasLoaded);
+    void serveUnixSocket();
+
+    // String from CLI to be parsed into a File object
+    std::string argSocketPath;
+
+    std::optional<juce::File> socketPathOpt;
+    std::size_t maxNumInstances{ 4 };
+
+    // instances by plugin path
+    std::map<juce::String, WarmPlugin> warmPlugins;
+    std::uint64_t numRequests{ 0 };
+};
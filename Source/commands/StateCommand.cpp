@@ -121,28 +121,33 @@ std::shared_ptr<CLI::App> StateCommand::createApp() {
 void StateCommand::execute() {
     const double dummySampleRate{ 48000.0 };
     const int dummyBlockSize{ 1024 };
-    const size_t dummyInputLength{ 1024 };
-    const size_t firstSampleIndex{ 0 };
     const auto plugin = PluginUtils::createPluginInstance(
         pluginPath.getFullPathName(), dummySampleRate, dummyBlockSize
     );
+    executeWithPlugin(*plugin);
+}
+
+void StateCommand::executeWithPlugin(juce::AudioPluginInstance& plugin) {
+    const double dummySampleRate{ 48000.0 };
+    const size_t dummyInputLength{ 1024 };
+    const size_t firstSampleIndex{ 0 };
     juce::MemoryBlock state;
 
     if (inputFilePath == juce::File{}) {
         // Default state only
-        plugin->getStateInformation(state);
+        plugin.getStateInformation(state);
     } else if (inputFilePath.hasFileExtension("json")) {
         // Parse the automation file and output the state
         auto automation = parseParameters(
-            *plugin, dummySampleRate, dummyInputLength, std::optional{ inputFilePath }, {}
+            plugin, dummySampleRate, dummyInputLength, std::optional{ inputFilePath }, {}
         );
-        Automation::applyParameters(*plugin, automation, firstSampleIndex);
-        plugin->getStateInformation(state);
+        Automation::applyParameters(automation, firstSampleIndex);
+        plugin.getStateInformation(state);
 
     } else {
         // Load the state and return the plugin's parameter values
-        loadPluginStateFromFile(*plugin, inputFilePath, state);
-        auto params = getParameterValuesAsJson(plugin->getParameters());
+        loadPluginStateFromFile(plugin, inputFilePath, state);
+        auto params = getParameterValuesAsJson(plugin.getParameters());
         outputResult(params.dump(4), outputFilePath, overwriteOutputFile);
         return;
     }
@@ -1,9 +1,13 @@
 #include "commands/AudioDiffCommand.h"
+#include "commands/BatchCommand.h"
+#include "commands/BenchmarkCommand.h"
 #include "commands/BusLayoutsCommand.h"
 #include "commands/GenerateAutomationCommand.h"
 #include "commands/ListParametersCommand.h"
 #include "commands/ProcessCommand.h"
+#include "commands/ServeCommand.h"
 #include "commands/StateCommand.h"
+#include "PluginScanCache.h"
 
 #include <iterator>
 #include <juce_events/juce_events.h>
@@ -25,6 +29,15 @@ static int runCommandLine(std::vector<std::string>& commandLineParameters) {
         "Show version information"
     );
 
+    app.add_flag_callback(
+        "--noScanCache", []() { PluginScanCache::setMode(PluginScanCache::Mode::bypass); },
+        "Scan the plugin without using or updating the plugin scan cache"
+    );
+    app.add_flag_callback(
+        "--rebuildScanCache", []() { PluginScanCache::setMode(PluginScanCache::Mode::rebuild); },
+        "Discard the plugin scan cache and scan the plugin again"
+    );
+
     app.footer("Use 'plugalyzer <subcommand> --help' to see options for each subcommand.");
 
     // set up subcommands
@@ -46,6 +59,15 @@ static int runCommandLine(std::vector<std::string>& commandLineParameters) {
     BusLayoutsCommand blc;
     registerSubcommand(app, blc);
 
+    BatchCommand bc;
+    registerSubcommand(app, bc);
+
+    ServeCommand sc;
+    registerSubcommand(app, sc);
+
+    BenchmarkCommand bmc;
+    registerSubcommand(app, bmc);
+
     try {
         app.parse(commandLineParameters);
     } catch (const CLI::Error& error) {
@@ -1,7 +1,9 @@
 #include "PluginProcessor.h"
 
 #include "PlugalyzeeAudio.h"
+#include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <format>
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
@@ -33,6 +35,9 @@ PlugalyzeeAudioProcessor::PlugalyzeeAudioProcessor() :
     params.outGain = static_cast<AudioParameterFloat*>(state.getParameter(id::outGainDecibels));
 
     paramDebugger = std::make_unique<ParameterUpdateDebugger>(state, params);
+
+    violateRealtime = std::getenv("PLUGALYZEE_VIOLATE_REALTIME") != nullptr;
+    mixSidechain = std::getenv("PLUGALYZEE_MIX_SIDECHAIN") != nullptr;
 }
 
 PlugalyzeeAudioProcessor::~PlugalyzeeAudioProcessor()
@@ -111,6 +116,10 @@ void PlugalyzeeAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBl
         .numChannels = static_cast<uint32>(getTotalNumOutputChannels())
     };
     processor.prepare(spec);
+    singlePrecisionBuffer.setSize(
+        std::max(getTotalNumInputChannels(), getTotalNumOutputChannels()),
+        samplesPerBlock
+    );
 }
 
 void PlugalyzeeAudioProcessor::releaseResources()
@@ -168,6 +177,23 @@ void PlugalyzeeAudioProcessor::processBlock(
 
     juce::ScopedNoDenormals noDenormals;
 
+    if (violateRealtime)
+    {
+        const std::scoped_lock lock{ violationMutex };
+        violationAllocations.emplace_back(static_cast<size_t>(buffer.getNumSamples()));
+        if (violationAllocations.size() > 16)
+            violationAllocations.clear();
+    }
+
+    if (mixSidechain && getBusCount(true) > 1)
+    {
+        auto mainBuffer = getBusBuffer(buffer, true, 0);
+        const auto sidechainBuffer = getBusBuffer(buffer, true, 1);
+        const auto numChannels = std::min(mainBuffer.getNumChannels(), sidechainBuffer.getNumChannels());
+        for (int channel = 0; channel < numChannels; ++channel)
+            mainBuffer.addFrom(channel, 0, sidechainBuffer, channel, 0, buffer.getNumSamples());
+    }
+
     processor.setParams(ParameterValues{
         .inGain = params.inGain->get(),
         .ratio = params.ratio->get(),
@@ -184,6 +210,21 @@ void PlugalyzeeAudioProcessor::processBlock(
     processor.process(context);
 }
 
+void PlugalyzeeAudioProcessor::processBlock(
+    juce::AudioBuffer<double>& buffer,
+    juce::MidiBuffer& midiMessages
+)
+{
+    singlePrecisionBuffer.makeCopyOf(buffer, true);
+    processBlock(singlePrecisionBuffer, midiMessages);
+    buffer.makeCopyOf(singlePrecisionBuffer, true);
+}
+
+bool PlugalyzeeAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
 bool PlugalyzeeAudioProcessor::hasEditor() const
 {
     return true;
@@ -2,6 +2,8 @@
 
 #include "PlugalyzeeAudio.h"
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <mutex>
+#include <vector>
 
 class PlugalyzeeAudioProcessor final : public juce::AudioProcessor
 {
@@ -15,7 +17,8 @@ public:
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
 
     void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlock(juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override;
@@ -40,6 +43,16 @@ private:
     juce::AudioProcessorValueTreeState state;
     PlugalyzeeParams params;
     PlugalyzeeDSP processor;
+    // the DSP only works in single precision, so double precision blocks are processed in here
+    juce::AudioBuffer<float> singlePrecisionBuffer;
+    // allocates and locks in processBlock if the PLUGALYZEE_VIOLATE_REALTIME environment variable
+    // is set, so hosts' real-time safety audits have something to find
+    bool violateRealtime{ false };
+    std::mutex violationMutex;
+    std::vector<std::vector<float>> violationAllocations;
+    // adds the sidechain to the main input if the PLUGALYZEE_MIX_SIDECHAIN environment variable
+    // is set, so what hosts feed into the sidechain can be heard in the output
+    bool mixSidechain{ false };
     std::unique_ptr<ParameterUpdateDebugger> paramDebugger;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PlugalyzeeAudioProcessor)
 };
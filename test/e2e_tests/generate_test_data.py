@@ -1,6 +1,11 @@
+import json
+import math
 from pathlib import Path
+import shutil
+import struct
 from subprocess import run
 from typing import List
+import wave
 
 from test_utils import TestPaths
 
@@ -35,6 +40,56 @@ class ProcessWithAudioAndGeneratorSidechainPrep(TestPrep):
         ]
 
 
+class ProcessWithAutomationPrep(TestPrep):
+    """A full render of the generator with the parameters automated at samples in the middle of blocks"""
+    def __init__(self, paths: TestPaths, filename: str, param_file: str, arguments: List[str]) -> None:
+        super().__init__(paths)
+        self.prepped_data = paths.output_folder / filename
+        self.command = [
+            "process", "-p", paths.plugalyzee,
+            "-g", f"{paths.config_folder / "generator-2ch-sine-noise.json"}",
+            "--paramFile", f"{paths.config_folder / param_file}",
+            "-o", self.prepped_data, "-y"
+        ] + arguments
+
+
+class MixedSampleRatesPrep(TestPrep):
+    """A silent input at 48 kHz, and a sine at 44.1 kHz, along with the same sine at 48 kHz to compare to"""
+    def __init__(self, paths: TestPaths) -> None:
+        super().__init__(paths)
+        self.main_input = paths.output_folder / "mixed-sample-rates-silence-48k.wav"
+        self.sidechain_input = paths.output_folder / "mixed-sample-rates-sine-44k1.wav"
+        self.reference = paths.output_folder / "mixed-sample-rates-sine-48k.wav"
+        self.reference_range = paths.output_folder / "mixed-sample-rates-sine-48k-range.wav"
+        self.prepped_data = None
+
+    @staticmethod
+    def write_sine(path: Path, sample_rate: int, amplitude: float, start: float = 0.0, duration: float = 1.0):
+        """Write a second of a 500 Hz stereo sine, or a part of it, faded in and out so resampling doesn't ring at its ends"""
+        frames = bytearray()
+        for i in range(round(duration * sample_rate)):
+            time = start + i / sample_rate
+            fade = max(0.0, min(1.0, time / 0.05, (1.0 - time) / 0.05))
+            sample = round(amplitude * fade * math.sin(2.0 * math.pi * 500.0 * time) * 32767)
+            frames += struct.pack('<hh', sample, sample)
+        with wave.open(str(path), 'wb') as file:
+            file.setnchannels(2)
+            file.setsampwidth(2)
+            file.setframerate(sample_rate)
+            file.writeframes(bytes(frames))
+
+    def prep_test(self):
+        self.write_sine(self.main_input, 48000, 0.0)
+        self.write_sine(self.sidechain_input, 44100, 0.1)
+        self.write_sine(self.reference, 48000, 0.1)
+        self.write_sine(self.reference_range, 48000, 0.1, 0.25, 0.5)
+
+    def cleanup(self):
+        for file in (self.main_input, self.sidechain_input, self.reference, self.reference_range):
+            if file.exists():
+                file.unlink()
+
+
 class StateDefaultBinaryToJsonParamsPrep(TestPrep):
     def __init__(self, paths: TestPaths) -> None:
         super().__init__(paths)
@@ -86,3 +141,59 @@ class AudioDiffFailPrep(TestPrep):
         if self.prepped_data_t and self.prepped_data_t.exists():
             self.prepped_data_t.unlink()
         
+
+class AudioDiffAlignPrep(AudioDiffFailPrep):
+    def __init__(self, paths: TestPaths) -> None:
+        super().__init__(paths)
+        self.prepped_data_t = paths.output_folder / "audiodiff-align-input-t.wav"
+        self.prepped_data_r = paths.output_folder / "audiodiff-align-input-r.wav"
+        # the reference starts 10ms (480 samples) later, so the test audio lags behind it
+        self.commands = (
+            [
+                "process", "-p", paths.plugalyzee,
+                f"-g", f"{paths.config_folder / "generator-2ch-noise.json"}",
+                "-o", self.prepped_data_t, "-y"
+            ],
+            [
+                "process", "-p", paths.plugalyzee,
+                f"-g", f"{paths.config_folder / "generator-2ch-noise.json"}",
+                "-o", self.prepped_data_r, "-y",
+                "--start=10ms"
+            ],
+        )
+
+
+class AudioDiffDirectoryPrep(TestPrep):
+    """Test and reference directories with a matching and a differing pair, and a manifest of them"""
+    def __init__(self, paths: TestPaths) -> None:
+        super().__init__(paths)
+        self.prepped_data = paths.output_folder / "audiodiff-directories"
+        self.test_folder = self.prepped_data / "test"
+        self.reference_folder = self.prepped_data / "reference"
+        self.manifest = self.prepped_data / "manifest.json"
+        noise = f"{paths.config_folder / "generator-2ch-noise.json"}"
+        self.commands = (
+            ["process", "-p", paths.plugalyzee, "-g", noise, "-o", self.test_folder / "same.wav"],
+            ["process", "-p", paths.plugalyzee, "-g", noise, "-o", self.reference_folder / "same.wav"],
+            ["process", "-p", paths.plugalyzee, "-g", noise, "-o", self.test_folder / "sub" / "different.wav"],
+            [
+                "process", "-p", paths.plugalyzee, "-g", noise,
+                "-o", self.reference_folder / "sub" / "different.wav",
+                "--param", "In Gain:0.15"
+            ],
+        )
+
+    def prep_test(self):
+        self.cleanup()
+        (self.test_folder / "sub").mkdir(parents=True)
+        (self.reference_folder / "sub").mkdir(parents=True)
+        for cmd in self.commands:
+            run([self.paths.plugalyzer] + cmd, check=True)
+        self.manifest.write_text(json.dumps([
+            {"test": "test/same.wav", "reference": "reference/same.wav"},
+            {"test": "test/sub/different.wav", "reference": "reference/sub/different.wav"},
+        ]))
+
+    def cleanup(self):
+        if self.prepped_data.exists():
+            shutil.rmtree(self.prepped_data)
@@ -1,9 +1,12 @@
 import hashlib
 import json
 import logging
+import os
 from pathlib import Path
 from subprocess import CompletedProcess, run
 import sys
+import wave
+from xml.etree import ElementTree
 from typing import List, Optional, Union
 import re
 
@@ -20,6 +23,7 @@ class TestCase:
     output_file: Optional[str]
     prep: Optional[TestPrep]
     correct_exit_code: int
+    environment: Optional[dict]
     exit_code: int
     correct_output: Union[bytes, str, re.Pattern]
     output: Union[bytes, str]
@@ -32,6 +36,7 @@ class TestCase:
         self.output_file = None
         self.prep = None
         self.correct_exit_code = 0
+        self.environment = None
         self.correct_output = correct_output
         self.failures = failures
         self.paths = paths
@@ -66,7 +71,8 @@ class TestCase:
         and add to the failed tests if they don't match
         """
         logging.debug(f"Test: {self.description}")
-        result = run([self.paths.plugalyzer] + self.command, capture_output=True)
+        env = {**os.environ, **self.environment} if self.environment else None
+        result = run([self.paths.plugalyzer] + self.command, capture_output=True, env=env)
         if result.stderr:
             logging.warning(result.stderr.decode('utf-8', errors='replace'))
 
@@ -144,6 +150,17 @@ class HelpListParameters(TestCase):
             )
         )
 
+class HelpBenchmark(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths,
+            "Help: benchmark",
+            ["benchmark", "-h"],
+            re.compile(
+                r"^Measures how long a plugin takes to process at different block sizes and sample rates\s+benchmark \[OPTIONS\]\s+OPTIONS:.*?$",
+                re.DOTALL | re.MULTILINE
+            )
+        )
+
 class HelpGenerateAutomation(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         super().__init__(failures, paths,
@@ -285,6 +302,31 @@ class GenerateAutomationFile(TestCase):
         )
         self.output_file = outfile
 
+class BenchmarkJsonStdout(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths,
+            "Benchmark: json, stdout",
+            [
+                "benchmark", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "--blockSizes=64,512", "--sampleRates=44100,48000",
+                "--warmup=0", "--duration=100ms", "--repetitions=2",
+                "-f", "json"
+            ],
+            "44100:64 44100:512 48000:64 48000:512"
+        )
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get the measured combinations, if every measurement has its values"""
+        try:
+            results = json.loads(result.stdout.decode('utf-8'))["results"]
+        except (ValueError, KeyError):
+            return ''
+        keys = ["nanosecondsPerSample", "minNanosecondsPerSample", "realTimeFactor", "worstBlockLoad"]
+        if not all(all(r.get(key, 0) > 0 for key in keys) for r in results):
+            return ''
+        return " ".join(f"{r['sampleRate']:g}:{r['blockSize']}" for r in results)
+
 class BusLayoutsDefaultStdout(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         super().__init__(failures, paths,
@@ -398,6 +440,167 @@ class AudiodiffSucceedWithTolerance(TestCase):
         )
         self.prep = prep
 
+class AudiodiffJsonReport(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffFailPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: json report",
+            [
+                "audioDiff",
+                "-t", f"{prep.prepped_data_t}",
+                "-r", f"{prep.prepped_data_r}",
+                "-d", "-20dB",
+                "-w", "4",
+                "-f", "json"
+            ],
+            "passed, 2 channels, consistent totals"
+        )
+        self.prep = prep
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Check that the overall metrics agree with the channels' metrics"""
+        try:
+            report = json.loads(result.stdout.decode('utf-8'))
+        except ValueError:
+            return ''
+        channels = report["channels"]
+        divergent = [c["firstDivergentSample"] for c in channels if c["firstDivergentSample"] is not None]
+        consistent = (
+            report["samplesAboveTolerance"] == sum(c["samplesAboveTolerance"] for c in channels)
+            and report["peak"] == max(c["peak"] for c in channels)
+            and report["firstDivergentSample"] == (min(divergent) if divergent else None)
+            and abs(report["rms"] - sum(c["rms"] for c in channels) / len(channels)) < 1e-9
+        )
+        return f"{'passed' if report['passed'] else 'failed'}, {len(channels)} channels, " \
+               f"{'consistent' if consistent else 'inconsistent'} totals"
+
+class AudiodiffAlign(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffAlignPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: align offset audio",
+            [
+                "audioDiff",
+                "-t", f"{prep.prepped_data_t}",
+                "-r", f"{prep.prepped_data_r}",
+                "--align",
+                "-f", "json"
+            ],
+            "offset 480, peak 0.0"
+        )
+        self.prep = prep
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get the offset found and the remaining difference"""
+        try:
+            report = json.loads(result.stdout.decode('utf-8'))
+        except ValueError:
+            return ''
+        return f"offset {report['testOffset']}, peak {report['peak']}"
+
+class AudiodiffSpectralReport(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffSucceedPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: spectral report",
+            [
+                "audioDiff",
+                "-t", f"{prep.prepped_data}",
+                "-r", f"{prep.prepped_data}",
+                "--spectral",
+                "--bands", "200,5000",
+                "-w", "4",
+                "-f", "json"
+            ],
+            "passed, 3 contiguous bands, 0 worst frames"
+        )
+        self.prep = prep
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Check that the bands cover the spectrum without gaps"""
+        try:
+            report = json.loads(result.stdout.decode('utf-8'))
+        except ValueError:
+            return ''
+        bands = report["bands"]
+        contiguous = (
+            bands[0]["lowFrequency"] == 0
+            and all(a["highFrequency"] == b["lowFrequency"] for a, b in zip(bands, bands[1:]))
+            and bands[-1]["highFrequency"] == report["sampleRate"] / 2
+        )
+        return f"{'passed' if report['passed'] else 'failed'}, {len(bands)} " \
+               f"{'contiguous' if contiguous else 'non-contiguous'} bands, " \
+               f"{len(report['worstFrames'])} worst frames"
+
+class AudiodiffSpectralFail(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffFailPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: spectral fail",
+            [
+                "audioDiff",
+                "-t", f"{prep.prepped_data_t}",
+                "-r", f"{prep.prepped_data_r}",
+                "--spectral"
+            ],
+            re.compile(
+                r"^\s+Band\s+Error\s+Tolerance\s+Worst frame\n(.*(passed|FAILED)\n){5}$"
+            )
+        )
+        self.prep = prep
+        self.correct_exit_code = 1
+
+class AudiodiffDirectories(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffDirectoryPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: compare directories",
+            [
+                "audioDiff",
+                "-t", f"{prep.test_folder}",
+                "-r", f"{prep.reference_folder}",
+                "-w", "2",
+                "-f", "json"
+            ],
+            "2 pairs, 1 succeeded, 1 failed, 0 errors, failed: sub/different.wav"
+        )
+        self.prep = prep
+        self.correct_exit_code = 1
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Summarize the suite report"""
+        try:
+            report = json.loads(result.stdout.decode('utf-8'))
+        except ValueError:
+            return ''
+        failed = [pair["name"] for pair in report["results"] if not pair["passed"]]
+        return f"{report['pairs']} pairs, {report['succeeded']} succeeded, " \
+               f"{report['failed']} failed, {report['errors']} errors, failed: {', '.join(failed)}"
+
+class AudiodiffManifestJUnit(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.AudioDiffDirectoryPrep(paths)
+        super().__init__(failures, paths,
+            "Audiodiff: manifest with a JUnit report",
+            [
+                "audioDiff",
+                "-m", f"{prep.manifest}",
+                "-f", "xml"
+            ],
+            "2 tests, 1 failures, 0 errors"
+        )
+        self.prep = prep
+        self.correct_exit_code = 1
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Summarize the JUnit report"""
+        try:
+            suite = ElementTree.fromstring(result.stdout)
+        except ElementTree.ParseError:
+            return ''
+        return f"{suite.get('tests')} tests, {suite.get('failures')} failures, " \
+               f"{suite.get('errors')} errors"
+
 class ProcessWithGenerator(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         outfile = paths.output("process-with-generator.wav")
@@ -430,6 +633,279 @@ class ProcessWithGenerator(TestCase):
         if failed:
             self.failures.failed_tests.append(self)
 
+class ProcessWithGeneratorW64(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator.w64")
+        # the samples must match the ones of the WAV file written by the same render
+        with wave.open(paths.expected('process-with-generator.wav')) as expected:
+            expected_samples = expected.readframes(expected.getnframes())
+        super().__init__(failures, paths,
+            "Process with generator to a Wave64 file",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json')
+            ],
+            hashlib.sha256(expected_samples).digest()
+        )
+        self.output_file = outfile
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get a SHA256 digest of the samples in the data chunk"""
+        if not Path(self.output_file).exists():
+            return b''
+        data = Path(self.output_file).read_bytes()
+        # riff and wave GUIDs and the riff size, followed by the fmt chunk
+        fmt_chunk_size = int.from_bytes(data[56:64], 'little')
+        data_chunk_start = 40 + fmt_chunk_size
+        data_size = int.from_bytes(data[data_chunk_start + 16:data_chunk_start + 24], 'little') - 24
+        samples_start = data_chunk_start + 24
+        return hashlib.sha256(data[samples_start:samples_start + data_size]).digest()
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+
+        # samples differ slightly on macOS, so only check that writing succeeded
+        if self.exit_code != self.correct_exit_code:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorTail(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-tail.wav")
+        # the plugin has no tail, so the output ends with the 2 second input instead of
+        # being padded to whole blocks
+        with wave.open(paths.expected('process-with-generator.wav')) as expected:
+            expected_samples = expected.readframes(48000 * 2)
+        super().__init__(failures, paths,
+            "Process with generator, rendering the tail",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--tail", "--tailWindow=100ms"
+            ],
+            hashlib.sha256(expected_samples).digest()
+        )
+        self.output_file = outfile
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get a SHA256 digest of the samples"""
+        if not Path(self.output_file).exists():
+            return b''
+        with wave.open(self.output_file) as output:
+            return hashlib.sha256(output.readframes(output.getnframes())).digest()
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+
+        # samples differ slightly on macOS, so only check that writing succeeded
+        if self.exit_code != self.correct_exit_code:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorRange(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-range.wav")
+        # the pre-roll reaches back to the start, so the range matches the same part of a
+        # full render
+        with wave.open(paths.expected('process-with-generator.wav')) as expected:
+            expected.setpos(48000)
+            expected_samples = expected.readframes(24000)
+        super().__init__(failures, paths,
+            "Process a range of a generator with pre-roll",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--start=1s", "--duration=500ms", "--preRoll=1s"
+            ],
+            hashlib.sha256(expected_samples).digest()
+        )
+        self.output_file = outfile
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get a SHA256 digest of the samples"""
+        if not Path(self.output_file).exists():
+            return b''
+        with wave.open(self.output_file) as output:
+            return hashlib.sha256(output.readframes(output.getnframes())).digest()
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+
+        # samples differ slightly on macOS, so only check that writing succeeded
+        if self.exit_code != self.correct_exit_code:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorRangeAutomation(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-range-automation.wav")
+        # the automation changes before the pre-roll, during it and during the range, so it has
+        # to be sought to the start of the pre-roll. the plugin has no memory with its default
+        # attack and release, and blocks are split at the keyframes,
+        # so the range is exactly the same as that part of the full render.
+        prep = generate_test_data.ProcessWithAutomationPrep(
+            paths, "process-with-generator-range-automation-full.wav", "plug-audio-automation.json",
+            ["--automationResolution=0"]
+        )
+        super().__init__(failures, paths,
+            "Process a range of a generator with automation and a pre-roll shorter than the start",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-automation.json'),
+                "--automationResolution=0",
+                "--start=1s", "--duration=500ms", "--preRoll=250ms"
+            ],
+            "24000 samples matching the full render"
+        )
+        self.output_file = outfile
+        self.prep = prep
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Compare the samples to the same range of the full render"""
+        if not Path(self.output_file).exists():
+            return ''
+        with wave.open(self.output_file) as output, wave.open(f"{self.prep.prepped_data}") as full:
+            samples = output.readframes(output.getnframes())
+            full.setpos(48000)
+            expected_samples = full.readframes(24000)
+            matching = "matching" if samples == expected_samples else "differing from"
+            return f"{output.getnframes()} samples {matching} the full render"
+
+class ProcessWithGeneratorAutomationResolution(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths, resolution: int = 0) -> None:
+        outfile = paths.output("process-with-generator-automation-resolution.wav")
+        # compared to a render applying the automation once per block
+        prep = generate_test_data.ProcessWithAutomationPrep(
+            paths, "process-with-generator-automation-per-block.wav",
+            "plug-audio-automation-resolution.json", []
+        )
+        # the steps in the automation only land on their keyframes with the option,
+        # while the per-block render applies them at the start of the next block
+        differences = ["24001-24575", "42001-43007", "60001-60415"]
+        if resolution > 0:
+            # the ramp from 73728 to 83968 is only applied at the start of every block without
+            # the option, so it's only followed within the blocks with an interval
+            differences += [
+                f"{block * 1024 + resolution}-{block * 1024 + 1023}" for block in range(72, 82)
+            ]
+        super().__init__(failures, paths,
+            f"Process with generator, applying automation with a resolution of {resolution}",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-automation-resolution.json'),
+                f"--automationResolution={resolution}"
+            ],
+            ", ".join(differences)
+        )
+        self.output_file = outfile
+        self.prep = prep
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get the first and last sample differing from the per-block render in every block"""
+        if not Path(self.output_file).exists():
+            return ''
+        with wave.open(self.output_file) as output, wave.open(f"{self.prep.prepped_data}") as per_block:
+            frame_size = output.getnchannels() * output.getsampwidth()
+            samples = output.readframes(output.getnframes())
+            per_block_samples = per_block.readframes(per_block.getnframes())
+        differing_blocks = {}
+        for frame in range(min(len(samples), len(per_block_samples)) // frame_size):
+            start = frame * frame_size
+            if samples[start:start + frame_size] != per_block_samples[start:start + frame_size]:
+                first, _ = differing_blocks.get(frame // 1024, (frame, frame))
+                differing_blocks[frame // 1024] = (first, frame)
+        return ", ".join(f"{first}-{last}" for first, last in differing_blocks.values())
+
+class ProcessWithGeneratorAutomationInterval(ProcessWithGeneratorAutomationResolution):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        # every block is split into sub-blocks of 250 samples, and a shorter one at its end
+        super().__init__(failures, paths, 250)
+
+class ProcessWithGeneratorOutputSampleRate(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-44k1.wav")
+        super().__init__(failures, paths,
+            "Process with generator, resampling the output",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--outputSampleRate=44100"
+            ],
+            # 94 blocks of 1024 samples at 48 kHz
+            f"44100 {round(94 * 1024 * 44100 / 48000)}"
+        )
+        self.output_file = outfile
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get the sample rate and length of the output"""
+        if not Path(self.output_file).exists():
+            return ''
+        with wave.open(self.output_file) as output:
+            return f"{output.getframerate()} {output.getnframes()}"
+
+class ProcessWithGeneratorRealtimeAudit(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-audited.wav")
+        super().__init__(failures, paths,
+            "Process with generator, auditing real-time safety",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--auditRealtime"
+            ],
+            re.compile(r"(?s).*Real-time safety audit:\n  \d+ of \d+ processBlock calls weren't real-time safe\n")
+        )
+        self.output_file = outfile
+        # the audit is only available on Linux
+        if not sys.platform.startswith('linux'):
+            self.correct_exit_code = 1
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get the audit report, if the output was written"""
+        if not Path(self.output_file).exists():
+            return ''
+        return result.stderr.decode('utf-8', errors='replace').replace('\r\n', '\n')
+
+    def verify_output(self):
+        if sys.platform.startswith('linux'):
+            return super().verify_output()
+
+        if self.exit_code != self.correct_exit_code:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorRealtimeViolations(ProcessWithGeneratorRealtimeAudit):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths)
+        self.description = "Process with generator, finding real-time safety violations"
+        # the plugin allocates and locks a mutex in every processBlock call
+        self.environment = {"PLUGALYZEE_VIOLATE_REALTIME": "1"}
+        self.correct_output = re.compile(
+            r"(?s).*Real-time safety audit:\n  ([1-9]\d*) of \1 processBlock calls weren't real-time safe\n"
+            r"  allocations +[1-9]\d*\n  deallocations +\d+\n  locks +[1-9]\d*\n"
+        )
+
+class ProcessWithGeneratorFailOnRealtimeViolations(ProcessWithGeneratorRealtimeViolations):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths)
+        self.description = "Process with generator, failing on real-time safety violations"
+        self.command += ["--failOnRealtimeViolations"]
+        if sys.platform.startswith('linux'):
+            self.correct_exit_code = 3
+
 class ProcessWithGeneratorTextInput(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         outfile = paths.output("process-with-generator.wav")
@@ -464,6 +940,188 @@ class ProcessWithGeneratorTextInput(TestCase):
         if failed:
             self.failures.failed_tests.append(self)
 
+class ProcessWithGeneratorPipelined(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-pipelined.wav")
+        super().__init__(failures, paths,
+            "Process with generator using a pipeline",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--pipeline",
+                "--pipelineDepth", "2"
+            ],
+            bytes.fromhex("98ea9a73c5e839aa46ec4b963e3534bc1ca519e518bd9640e7110258be939c4f")
+        )
+        self.output_file = outfile
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+        
+        expected_output = self.paths.expected('process-with-generator.wav')
+        cmd = [
+            "audioDiff",
+            "-t", self.output_file,
+            "-r", expected_output
+        ]
+
+        result = run([self.paths.plugalyzer] + cmd, capture_output=True)
+
+        failed = result.returncode != 0
+        if failed:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorDoublePrecision(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        outfile = paths.output("process-with-generator-double.wav")
+        super().__init__(failures, paths,
+            "Process with generator in double precision",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{outfile}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--doublePrecision"
+            ],
+            # the plugin processes in single precision internally,
+            # so the output matches the single precision render
+            bytes.fromhex("98ea9a73c5e839aa46ec4b963e3534bc1ca519e518bd9640e7110258be939c4f")
+        )
+        self.output_file = outfile
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Get a SHA256 digest of the output, unless processing fell back to single precision"""
+        if b"Falling back to single precision" in result.stderr:
+            return b''
+        return super()._get_command_output(result)
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+
+        expected_output = self.paths.expected('process-with-generator.wav')
+        cmd = [
+            "audioDiff",
+            "-t", self.output_file,
+            "-r", expected_output
+        ]
+
+        result = run([self.paths.plugalyzer] + cmd, capture_output=True)
+
+        failed = result.returncode != 0 or self.output == b''
+        if failed:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithGeneratorStats(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        self.audio_file = paths.output("process-with-generator-stats.wav")
+        statsfile = paths.output("process-with-generator-stats.json")
+        super().__init__(failures, paths,
+            "Process with generator and output render statistics",
+            [
+                "process", "-p", paths.plugalyzee,
+                "-g", paths.config('generator-2ch-sine-noise.json'),
+                "-o", f"{self.audio_file}",
+                "--paramFile", paths.config('plug-audio-process-with-generator.json'),
+                "--stats", "json",
+                "--statsOutput", f"{statsfile}"
+            ],
+            re.compile(r'^\{.*"processBlock".*"p99Microseconds".*"realTimeFactor".*"stages".*\}$', re.DOTALL)
+        )
+        self.output_file = statsfile
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        if Path(self.audio_file).exists():
+            Path(self.audio_file).unlink()
+        return super().__exit__(exc_type, exc_val, exc_tb)
+
+class BatchWithGenerator(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        self.first_outfile = paths.output("batch-with-generator-1.wav")
+        outfile = paths.output("batch-with-generator-2.wav")
+        job = {
+            "generatorInput": paths.config('generator-2ch-sine-noise.json'),
+            "paramFile": paths.config('plug-audio-process-with-generator.json'),
+        }
+        jobs = [
+            dict(job, output=f"{self.first_outfile}"),
+            dict(job, output=f"{outfile}"),
+        ]
+        super().__init__(failures, paths,
+            "Batch process the same job twice using a single plugin instance",
+            [
+                "batch", "-p", paths.plugalyzee,
+                "--jobs", json.dumps(jobs)
+            ],
+            # the second job must not be affected by the first one
+            bytes.fromhex("98ea9a73c5e839aa46ec4b963e3534bc1ca519e518bd9640e7110258be939c4f")
+        )
+        self.output_file = outfile
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+        
+        expected_output = self.paths.expected('process-with-generator.wav')
+        cmd = [
+            "audioDiff",
+            "-t", self.output_file,
+            "-r", expected_output
+        ]
+
+        result = run([self.paths.plugalyzer] + cmd, capture_output=True)
+
+        failed = result.returncode != 0
+        if failed:
+            self.failures.failed_tests.append(self)
+
+    def __exit__(self, exc_type, exc_val, exc_tb):
+        if Path(self.first_outfile).exists():
+            Path(self.first_outfile).unlink()
+        return super().__exit__(exc_type, exc_val, exc_tb)
+
+class BatchWithGeneratorParallel(BatchWithGenerator):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths)
+        self.description = "Batch process the same job twice using two workers"
+        self.command += ["--workers", "2"]
+
+class ServeListParametersTwice(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        request = {"command": "listParameters", "options": {"plugin": f"{paths.plugalyzee}", "format": "json"}}
+        self.requests = [
+            dict(request, id=1),
+            dict(request, id=2),
+            {"id": 3, "command": "shutdown"},
+        ]
+        super().__init__(failures, paths,
+            "Serve the same request twice using a warm plugin instance",
+            ["serve"],
+            (paths.expected_folder / "plug-audio-list-parameters-json.json").read_text('utf-8')
+        )
+
+    def run_command(self):
+        logging.debug(f"Test: {self.description}")
+        stdin = "".join(json.dumps(request) + "\n" for request in self.requests)
+        result = run([self.paths.plugalyzer] + self.command, input=stdin.encode('utf-8'), capture_output=True)
+        if result.stderr:
+            logging.warning(result.stderr.decode('utf-8', errors='replace'))
+
+        self.exit_code = result.returncode
+        self.responses = [json.loads(line) for line in result.stdout.decode('utf-8').splitlines() if line]
+        # the second request must reuse the instance and still produce the same output
+        self.output = self.responses[1].get("output", "") if len(self.responses) == 3 else ""
+
+    def verify_output(self):
+        super().verify_output()
+        warm = [response.get("warmInstance") for response in self.responses[:2]]
+        if warm != [False, True] and self not in self.failures.failed_tests:
+            logging.error(f"{self.description}: expected only the second request to use a warm instance")
+            self.failures.failed_tests.append(self)
+
 class ProcessWithAudioAndGeneratorSidechain(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         prep = generate_test_data.ProcessWithAudioAndGeneratorSidechainPrep(paths)
@@ -498,6 +1156,86 @@ class ProcessWithAudioAndGeneratorSidechain(TestCase):
         if failed:
             self.failures.failed_tests.append(self)
 
+class ProcessWithAudioAndGeneratorSidechainStdio(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.ProcessWithAudioAndGeneratorSidechainPrep(paths)
+        # raw output must match the samples of the file written by the non-streaming test
+        with wave.open(paths.expected('process-with-audio-and-generator.wav')) as expected:
+            expected_samples = expected.readframes(expected.getnframes())
+        super().__init__(failures, paths,
+            "Process WAV from stdin with generator sidechain, writing raw PCM to stdout",
+            [
+                "process", "-p", paths.plugalyzee_sidechain,
+                "-i", "-",
+                "-g", paths.config("generator-2ch-sine-440.json"),
+                "-o", "-", "--stdoutFormat", "s16le",
+            ],
+            hashlib.sha256(expected_samples).digest()
+        )
+        self.prep = prep
+
+    def run_command(self):
+        logging.debug(f"Test: {self.description}")
+        result = run([self.paths.plugalyzer] + self.command, input=self.prep.prepped_data.read_bytes(), capture_output=True)
+        if result.stderr:
+            logging.warning(result.stderr.decode('utf-8', errors='replace'))
+
+        self.exit_code = result.returncode
+        self.output = self._get_command_output(result)
+
+    def verify_output(self):
+        if sys.platform != 'darwin':
+            return super().verify_output()
+
+        # samples differ slightly on macOS, so only check that streaming worked
+        if self.exit_code != self.correct_exit_code:
+            self.failures.failed_tests.append(self)
+
+class ProcessWithMixedSampleRates(TestCase):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        prep = generate_test_data.MixedSampleRatesPrep(paths)
+        outfile = paths.output("process-with-mixed-sample-rates.wav")
+        super().__init__(failures, paths,
+            "Process a 48 kHz input with a 44.1 kHz sidechain",
+            [
+                "process", "-p", paths.plugalyzee_sidechain,
+                "-i", f"{prep.main_input}",
+                "-i", f"{prep.sidechain_input}",
+                "-o", f"{outfile}",
+            ],
+            "Aligned the test audio by an offset of 0 samples."
+        )
+        self.output_file = outfile
+        self.prep = prep
+        self.reference = prep.reference
+        # the plugin adds the sidechain to the silent main input,
+        # so the output is the sidechain resampled to 48 kHz
+        self.environment = {"PLUGALYZEE_MIX_SIDECHAIN": "1"}
+
+    def _get_command_output(self, result: CompletedProcess):
+        """Compare the output to the sine generated at 48 kHz, and get the offset between them"""
+        if not Path(self.output_file).exists():
+            return ''
+        diff = run([
+            self.paths.plugalyzer, "audioDiff",
+            "-t", self.output_file,
+            "-r", f"{self.reference}",
+            "--align", "--maxOffset", "16",
+            "-d", "-40dB"
+        ], capture_output=True)
+        if diff.returncode != 0:
+            return diff.stdout.decode('utf-8', errors='replace').strip()
+        offset = re.search(r"Aligned the test audio by an offset of -?\d+ samples\.", diff.stderr.decode('utf-8', errors='replace'))
+        return offset.group(0) if offset else ''
+
+class ProcessWithMixedSampleRatesRange(ProcessWithMixedSampleRates):
+    def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
+        super().__init__(failures, paths)
+        self.description = "Process a range of a 48 kHz input with a 44.1 kHz sidechain"
+        # the resampled sidechain isn't read from its start, so reading it starts over from the range
+        self.command += ["--start=250ms", "--duration=500ms"]
+        self.reference = self.prep.reference_range
+
 class ProcessSidechainMissingSidechain(TestCase):
     def __init__(self, failures: FailureLogger, paths: TestPaths) -> None:
         outfile = paths.output("process-with-audio-missing-sidechain.wav")
@@ -637,6 +1375,7 @@ def get_all_test_cases(failures: FailureLogger, paths: TestPaths) -> List[TestCa
         Version(failures, paths),
         Help(failures, paths),
         HelpListParameters(failures, paths),
+        HelpBenchmark(failures, paths),
         HelpGenerateAutomation(failures, paths),
         HelpBusLayouts(failures, paths),
         HelpProcess(failures, paths),
@@ -650,6 +1389,7 @@ def get_all_test_cases(failures: FailureLogger, paths: TestPaths) -> List[TestCa
         ListParametersJsonFile(failures, paths),
         GenerateAutomationStdout(failures, paths),
         GenerateAutomationFile(failures, paths),
+        BenchmarkJsonStdout(failures, paths),
         BusLayoutsDefaultStdout(failures, paths),
         BusLayoutsTextStdout(failures, paths),
         BusLayoutsJsonStdout(failures, paths),
@@ -659,9 +1399,34 @@ def get_all_test_cases(failures: FailureLogger, paths: TestPaths) -> List[TestCa
         AudiodiffSucceed(failures, paths),
         AudiodiffFail(failures, paths),
         AudiodiffSucceedWithTolerance(failures, paths),
+        AudiodiffJsonReport(failures, paths),
+        AudiodiffAlign(failures, paths),
+        AudiodiffSpectralReport(failures, paths),
+        AudiodiffSpectralFail(failures, paths),
+        AudiodiffDirectories(failures, paths),
+        AudiodiffManifestJUnit(failures, paths),
         ProcessWithGenerator(failures, paths),
+        ProcessWithGeneratorW64(failures, paths),
+        ProcessWithGeneratorTail(failures, paths),
+        ProcessWithGeneratorRange(failures, paths),
+        ProcessWithGeneratorRangeAutomation(failures, paths),
+        ProcessWithGeneratorAutomationResolution(failures, paths),
+        ProcessWithGeneratorAutomationInterval(failures, paths),
+        ProcessWithGeneratorOutputSampleRate(failures, paths),
+        ProcessWithGeneratorRealtimeAudit(failures, paths),
+        ProcessWithGeneratorRealtimeViolations(failures, paths),
+        ProcessWithGeneratorFailOnRealtimeViolations(failures, paths),
         ProcessWithGeneratorTextInput(failures, paths),
+        ProcessWithGeneratorPipelined(failures, paths),
+        ProcessWithGeneratorDoublePrecision(failures, paths),
+        ProcessWithGeneratorStats(failures, paths),
+        BatchWithGenerator(failures, paths),
+        BatchWithGeneratorParallel(failures, paths),
+        ServeListParametersTwice(failures, paths),
         ProcessWithAudioAndGeneratorSidechain(failures, paths),
+        ProcessWithAudioAndGeneratorSidechainStdio(failures, paths),
+        ProcessWithMixedSampleRates(failures, paths),
+        ProcessWithMixedSampleRatesRange(failures, paths),
         ProcessSidechainMissingSidechain(failures, paths),
         StateSaveDefaultBinary(failures, paths),
         SaveDefaultStateXml(failures, paths),